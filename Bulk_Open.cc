@@ -0,0 +1,287 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Ora++ -- a C++ interface to Oracle based on the Oracle Call Interface
+// Copyright (C) 2000-1 James Edwin Cain <me@jimcain.net>
+// 
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or any
+// later version.
+// 
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Bulk_Open.h"
+#include "Connection.h"
+#include "Connection_Pool.h"
+#include "Env.h"
+#include <oci.h>
+#include <errno.h>
+
+
+Oracle::Bulk_Open::Bulk_Open(const int threads, const int ms) throw(Oracle::Error)
+	: max_thr(threads), timeout_ms(ms), next(0), nfinished(0), expired(false), err_h(0), t_run(0)
+{
+	if (threads < 1 || ms < 0)
+	{
+		Value_Error e("Bulk_Open::Bulk_Open", "Invalid thread count or timeout");
+		e.desc << "threads = " << threads << "; timeout = " << ms;
+		throw e;
+	}
+	pthread_mutex_init(&mtx, 0);
+	pthread_cond_init(&cv, 0);
+}
+
+
+Oracle::Bulk_Open::~Bulk_Open() throw()
+{
+	join();
+	if (err_h)
+		OCIHandleFree((dvoid *) err_h, (ub4) OCI_HTYPE_ERROR);
+	pthread_cond_destroy(&cv);
+	pthread_mutex_destroy(&mtx);
+}
+
+
+void
+Oracle::Bulk_Open::add(Connection& db) throw(Oracle::Error)
+{
+	// a Pooled_Connection's session comes from its pool, not a logon
+	if (dynamic_cast<Pooled_Connection*>(&db))
+		throw Type_Error("Bulk_Open::add", "A Pooled_Connection cannot be opened by Bulk_Open");
+
+	Result r;
+	r.db = &db;
+	r.ok = r.timed_out = false;
+	r.attach_secs = r.logon_secs = 0;
+	res_v.push_back(r);
+}
+
+
+const Oracle::Bulk_Open::Result&
+Oracle::Bulk_Open::result(const int n) const throw(Oracle::Error)
+{
+	if (n < 0 || n >= res_v.size())
+	{
+		Value_Error e("Bulk_Open::result", "Subscript out of range");
+		e.desc << "subscript = " << n << "; connections = " << res_v.size();
+		throw e;
+	}
+	return res_v[n];
+}
+
+
+void
+Oracle::Bulk_Open::open_one(const int n) throw()
+{
+	// This follows Connection::open(), but records each step so that the
+	// timeout can interrupt a Connection only while it is inside OCI.
+	// Handles are freed only after leaving that state under the lock.
+	// The outcome is kept locally and stored under the lock, since run()
+	// may already have returned and reported this Connection.
+	pthread_mutex_lock(&mtx);
+	Result r = res_v[n];
+	pthread_mutex_unlock(&mtx);
+	Connection& db = *r.db;
+	phase_t reached = Waiting;
+	try
+	{
+		if (db.stat == Connection::connected)
+		{
+			r.ok = true;
+			r.attach_secs = db.t_attach;
+			r.logon_secs = db.t_logon;
+		}
+		else
+		{
+			db.init_handles();
+
+			pthread_mutex_lock(&mtx);
+			bool stop = expired;
+			if (!stop)
+				phase_v[n] = reached = Attaching;
+			pthread_mutex_unlock(&mtx);
+			if (stop)
+				throw Error("Bulk_Open::run", "Timed out before attaching");
+
+			double t = Env::now();
+			db.attach_server();
+			r.attach_secs = db.t_attach = Env::now() - t;
+
+			pthread_mutex_lock(&mtx);
+			phase_v[n] = reached = Logging_On;
+			pthread_mutex_unlock(&mtx);
+
+			t = Env::now();
+			db.log_on();
+			r.logon_secs = db.t_logon = Env::now() - t;
+			db.stat = Connection::connected;
+			r.ok = true;
+		}
+	}
+	catch (Error& e)
+	{
+		r.error = e.str();
+	}
+
+	pthread_mutex_lock(&mtx);
+	bool late = expired;
+	phase_v[n] = Finished;
+	if (!late)
+		res_v[n] = r;
+	nfinished++;
+	pthread_cond_broadcast(&cv);
+	pthread_mutex_unlock(&mtx);
+
+	// run() has reported this Connection as timed out, so a logon that
+	// completed anyway is undone
+	if (late && r.ok && reached == Logging_On)
+	{
+		db.stat = Connection::not_connected;
+		try
+		{
+			db.log_off();
+		}
+		catch (Error&)
+		{
+		}
+		r.ok = false;
+	}
+
+	if (!r.ok)
+	{
+		try
+		{
+			if (reached == Logging_On)
+				db.detach_server();
+		}
+		catch (Error&)
+		{
+		}
+		db.free_handles();
+	}
+}
+
+
+void*
+Oracle::Bulk_Open::thread_main(void* arg)
+{
+	((Bulk_Open*) arg)->work();
+	return 0;
+}
+
+
+void
+Oracle::Bulk_Open::work() throw()
+{
+	for (;;)
+	{
+		pthread_mutex_lock(&mtx);
+		int n = !expired && next < res_v.size() ? next++ : -1;
+		pthread_mutex_unlock(&mtx);
+		if (n < 0)
+			break;
+		open_one(n);
+	}
+}
+
+
+void
+Oracle::Bulk_Open::join() throw()
+{
+	for (int i=0; i < thr_v.size(); i++)
+		pthread_join(thr_v[i], 0);
+	thr_v.clear();
+}
+
+
+int
+Oracle::Bulk_Open::run() throw(Oracle::Error)
+{
+	// threads left behind by an earlier timeout must finish first
+	join();
+
+	// OCIBreak gets its own error handle; the workers' are in use
+	if (!err_h && OCIHandleAlloc(
+			(dvoid *) Env::env(),					// env handle
+			(dvoid **) &err_h,					// handle returned
+			(ub4) OCI_HTYPE_ERROR,					// handle type
+			(size_t) 0,						// user-def memory size
+			(dvoid **) 0))						// user-def memory ptr
+		throw Error("Bulk_Open::run", "OCIHandleAlloc failed for error handle");
+
+	double t0 = Env::now();
+	next = nfinished = 0;
+	expired = false;
+	phase_v.assign(res_v.size(), Waiting);
+	for (int i=0; i < res_v.size(); i++)
+	{
+		res_v[i].ok = res_v[i].timed_out = false;
+		res_v[i].attach_secs = res_v[i].logon_secs = 0;
+		res_v[i].error = "";
+	}
+
+	int nthr = max_thr < res_v.size() ? max_thr : res_v.size();
+	for (int i=0; i < nthr; i++)
+	{
+		pthread_t thr;
+		if (pthread_create(&thr, 0, thread_main, this))
+			break;
+		thr_v.push_back(thr);
+	}
+	if (thr_v.empty() && res_v.size())
+		throw Error("Bulk_Open::run", "Cannot create threads");
+
+	// wait for every Connection to finish, or the deadline
+	struct timespec deadline;
+	double t_end = t0 + timeout_ms / 1e3;
+	deadline.tv_sec = (time_t) t_end;
+	deadline.tv_nsec = (long) ((t_end - deadline.tv_sec) * 1e9);
+
+	pthread_mutex_lock(&mtx);
+	while (nfinished < res_v.size())
+	{
+		if (!timeout_ms)
+			pthread_cond_wait(&cv, &mtx);
+		else if (pthread_cond_timedwait(&cv, &mtx, &deadline) == ETIMEDOUT)
+			break;
+	}
+
+	// Report the stragglers as timed out and interrupt those inside OCI;
+	// those not started yet are skipped.  Their threads are left to
+	// finish and are joined by the destructor or the next run().
+	bool timed_out = nfinished < res_v.size();
+	if (timed_out)
+	{
+		expired = true;
+		for (int i=0; i < res_v.size(); i++)
+		{
+			if (phase_v[i] == Finished)
+				continue;
+			res_v[i].ok = false;
+			res_v[i].timed_out = true;
+			res_v[i].error = "Timed out";
+			if (phase_v[i] == Attaching || phase_v[i] == Logging_On)
+				OCIBreak((dvoid *) res_v[i].db->svr_h, err_h);
+		}
+	}
+	pthread_mutex_unlock(&mtx);
+
+	if (!timed_out)
+		join();
+	t_run = Env::now() - t0;
+
+	int nok = 0;
+	for (int i=0; i < res_v.size(); i++)
+		if (res_v[i].ok)
+			nok++;
+	return nok;
+}
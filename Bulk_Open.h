@@ -0,0 +1,107 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Ora++ -- a C++ interface to Oracle based on the Oracle Call Interface
+// Copyright (C) 2000-1 James Edwin Cain <me@jimcain.net>
+// 
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or any
+// later version.
+// 
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef ORAPP_BULK_OPEN_H
+#define ORAPP_BULK_OPEN_H
+
+#include "Oracle.h"
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+class OCIError;
+
+
+namespace Oracle
+{
+	class Connection;
+
+	// Opens many Connections concurrently, e.g. at service startup, so the
+	// total time is close to that of the slowest logon rather than the sum.
+	// run() returns at the timeout: Connections still attaching or logging
+	// on are reported as timed out and interrupted with OCIBreak, and their
+	// threads release them in the background.  Those Connections must not
+	// be used or destroyed until the Bulk_Open is destroyed (or run()
+	// again), which waits for the threads.  Pooled_Connections are not
+	// accepted, since their sessions come from the pool.
+	class Bulk_Open
+	{
+		public:
+			// types
+			struct Result							// outcome for one Connection
+			{
+				Connection* db;
+				bool ok;						// opened
+				bool timed_out;						// interrupted at the timeout
+				double attach_secs;					// time to attach
+				double logon_secs;					// time to log on
+				std::string error;					// error text if not ok
+			};
+
+			// constructors/destructor
+			Bulk_Open(
+				const int = 16,						// max threads
+				const int = 0)				throw(Error);	// timeout in ms (0==none)
+			virtual ~Bulk_Open()				throw();
+
+			// implementors
+			void add(Connection&)				throw(Error);	// open with the others
+			int run()					throw(Error);	// open all, returns #opened
+
+			// accessors
+			int size() const				throw()		// Connections added
+				{ return res_v.size(); }
+			const Result& result(const int) const		throw(Error);	// outcome by index, in order added
+			double secs() const				throw()		// elapsed time of run()
+				{ return t_run; }
+
+		protected:
+			// types
+			enum phase_t { Waiting, Attaching, Logging_On, Finished };
+
+			// protected implementors
+			void open_one(const int)			throw();	// open one Connection
+			void work()					throw();	// thread body
+			void join()					throw();	// wait for threads of last run()
+			static void* thread_main(void*);
+
+			// data members
+			int max_thr;
+			int timeout_ms;
+			std::vector<Result> res_v;
+			std::vector<phase_t> phase_v;					// progress, guarded by mtx
+			int next;							// next Connection to open
+			int nfinished;
+			bool expired;							// timeout reached, run() returned
+			std::vector<pthread_t> thr_v;					// threads of last run()
+			OCIError* err_h;						// error handle for OCIBreak
+			pthread_mutex_t mtx;
+			pthread_cond_t cv;						// a Connection finished
+			double t_run;
+
+		private:
+			// disallowed functions
+			Bulk_Open(const Bulk_Open&);
+			Bulk_Open& operator=(const Bulk_Open&);
+	};
+}
+
+#endif
@@ -0,0 +1,293 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Ora++ -- a C++ interface to Oracle based on the Oracle Call Interface
+// Copyright (C) 2000-1 James Edwin Cain <me@jimcain.net>
+// 
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or any
+// later version.
+// 
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Oracle.h"
+#include "Column_Batch.h"
+#include "Select_Stmt.h"
+#include "Date.h"
+#include <cstring>
+#include <oci.h>
+
+
+Oracle::Column_Batch::Column_Batch() throw()
+	: cap(0), rows(0)
+{
+}
+
+
+Oracle::Column_Batch::~Column_Batch() throw()
+{
+	free_data();
+}
+
+
+void
+Oracle::Column_Batch::init_data(const Select_Stmt& stmt, const int n) throw(Oracle::Error)
+{
+	OCIStmt* stmt_h = stmt.stmt_handle();
+	OCIError* err_h = stmt.err_handle();
+	OCIParam* parm_h;
+	sb2 precision(0);
+	sb1 scale(0);
+	ub2 col_type;
+	ub2 col_size;
+
+	free_data();
+	cap = n;
+	rows = 0;
+
+	for (int i=0; i < stmt.ncols(); i++)
+	{
+		// get parameter
+		parm_h = (OCIParam*) 0;
+		if(OCIParamGet(	stmt_h,
+				(ub4) OCI_HTYPE_STMT,
+				err_h,
+				(dvoid **) &parm_h,
+				(ub4) i + 1))							// position (one-based)
+			throw OCI_Error("Column_Batch::init_data", err_h);
+
+		// get column type and size
+		if(OCIAttrGet(	(dvoid*) parm_h,
+				(ub4) OCI_DTYPE_PARAM, 
+				(dvoid*) &col_type,
+				(ub4 *) 0,
+				(ub4) OCI_ATTR_DATA_TYPE, 
+				err_h))
+			throw OCI_Error("Column_Batch::init_data", err_h);
+		if(OCIAttrGet(	(dvoid*) parm_h,
+				(ub4) OCI_DTYPE_PARAM, 
+				(dvoid*) &col_size,
+				(ub4 *) 0,
+				(ub4) OCI_ATTR_DATA_SIZE, 
+				err_h))
+			throw OCI_Error("Column_Batch::init_data", err_h);
+
+		Column c;
+		switch(col_type)
+		{
+			case 1:		// VARCHAR2
+			case 11:	// ROWID
+			case 96:	// CHAR
+				c.type = String;
+				c.width = col_size;
+				break;
+
+			case 2:		// NUMBER
+				// integers of up to 18 digits fit in a long; anything else is a double
+				if(OCIAttrGet(	(dvoid*) parm_h,
+						(ub4) OCI_DTYPE_PARAM, 
+						(dvoid*) &precision,
+						(ub4 *) 0,
+						(ub4) OCI_ATTR_PRECISION, 
+						err_h))
+					throw OCI_Error("Column_Batch::init_data", err_h);
+				if(OCIAttrGet(	(dvoid*) parm_h,
+						(ub4) OCI_DTYPE_PARAM, 
+						(dvoid*) &scale,
+						(ub4 *) 0,
+						(ub4) OCI_ATTR_SCALE, 
+						err_h))
+					throw OCI_Error("Column_Batch::init_data", err_h);
+				if (scale == 0 && precision > 0 && precision <= 18 && sizeof(long) >= 8)
+				{
+					c.type = Long;
+					c.width = sizeof(long);
+				}
+				else
+				{
+					c.type = Double;
+					c.width = sizeof(double);
+				}
+				break;
+
+			case 12:	// DATE
+				c.type = Datetime;
+				c.width = sizeof(OCIDate);
+				break;
+
+			default:
+				throw Type_Error("Column_Batch::init_data", "Unsupported Oracle internal data type");
+		}
+
+		// one allocation per array; strings get an extra offset slot
+		c.buf = new char[n * c.width];
+		c.ind = new sb2[n];
+		c.len = new ub2[n];
+		c.off = c.type == String ? new int[n + 1] : 0;
+		c.nulls = new unsigned char[(n + 7) / 8];
+		cols.push_back(c);
+	}
+}
+
+
+void
+Oracle::Column_Batch::finish(const int n) throw()
+{
+	rows = n;
+	for (int i=0; i < cols.size(); i++)
+	{
+		Column& c = cols[i];
+
+		// build the null bitmap from the indicators; zero NULL numerics
+		std::memset(c.nulls, 0, (n + 7) / 8);
+		for (int r=0; r < n; r++)
+			if (c.ind[r] == -1)
+			{
+				c.nulls[r >> 3] |= 1 << (r & 7);
+				if (c.type == Long || c.type == Double)
+					std::memset(c.buf + r * c.width, 0, c.width);
+			}
+
+		// pack the fixed-width string slots into one run of characters;
+		// each value moves toward the front, so this can be done in place
+		if (c.type == String)
+		{
+			c.off[0] = 0;
+			for (int r=0; r < n; r++)
+			{
+				int l = c.ind[r] == -1 ? 0 : c.len[r];
+				if (c.off[r] != r * c.width)
+					std::memmove(c.buf + c.off[r], c.buf + r * c.width, l);
+				c.off[r + 1] = c.off[r] + l;
+			}
+		}
+	}
+}
+
+
+void
+Oracle::Column_Batch::free_data() throw()
+{
+	for (int i=0; i < cols.size(); i++)
+	{
+		delete [] cols[i].buf;
+		delete [] cols[i].ind;
+		delete [] cols[i].len;
+		delete [] cols[i].off;
+		delete [] cols[i].nulls;
+	}
+	cols.clear();
+	cap = rows = 0;
+}
+
+
+const Oracle::Column_Batch::Column&
+Oracle::Column_Batch::col(const int i, const char* module) const throw(Oracle::Error)
+{
+	if (i < 0 || i >= cols.size())
+	{
+		Value_Error e(module, "Column out of range");
+		e.desc << "subscript = " << i;
+		throw e;
+	}
+	return cols[i];
+}
+
+
+Oracle::Column_Batch::col_t
+Oracle::Column_Batch::type(const int i) const throw(Oracle::Error)
+{
+	return col(i, "Column_Batch::type(const int)").type;
+}
+
+
+const long*
+Oracle::Column_Batch::lng(const int i) const throw(Oracle::Error)
+{
+	const Column& c = col(i, "Column_Batch::lng(const int)");
+	if (c.type != Long)
+		throw Type_Error("Column_Batch::lng(const int)", "Column is not an integer column");
+	return (const long*) c.buf;
+}
+
+
+const double*
+Oracle::Column_Batch::dbl(const int i) const throw(Oracle::Error)
+{
+	const Column& c = col(i, "Column_Batch::dbl(const int)");
+	if (c.type != Double)
+		throw Type_Error("Column_Batch::dbl(const int)", "Column is not a floating point column");
+	return (const double*) c.buf;
+}
+
+
+const char*
+Oracle::Column_Batch::chars(const int i) const throw(Oracle::Error)
+{
+	const Column& c = col(i, "Column_Batch::chars(const int)");
+	if (c.type != String)
+		throw Type_Error("Column_Batch::chars(const int)", "Column is not a string column");
+	return c.buf;
+}
+
+
+const int*
+Oracle::Column_Batch::offsets(const int i) const throw(Oracle::Error)
+{
+	const Column& c = col(i, "Column_Batch::offsets(const int)");
+	if (c.type != String)
+		throw Type_Error("Column_Batch::offsets(const int)", "Column is not a string column");
+	return c.off;
+}
+
+
+const unsigned char*
+Oracle::Column_Batch::nulls(const int i) const throw(Oracle::Error)
+{
+	return col(i, "Column_Batch::nulls(const int)").nulls;
+}
+
+
+std::string
+Oracle::Column_Batch::str(const int i, const int r) const throw(Oracle::Error)
+{
+	const Column& c = col(i, "Column_Batch::str(const int, const int)");
+	if (c.type != String)
+		throw Type_Error("Column_Batch::str(const int, const int)", "Column is not a string column");
+	if (r < 0 || r >= rows)
+	{
+		Value_Error e("Column_Batch::str(const int, const int)", "Row out of range");
+		e.desc << "row = " << r;
+		throw e;
+	}
+	if (c.ind[r] == -1)
+		throw Value_Error("Column_Batch::str(const int, const int)", "Cannot make a string out of a NULL");
+	return std::string(c.buf + c.off[r], c.off[r + 1] - c.off[r]);
+}
+
+
+Oracle::Date
+Oracle::Column_Batch::date(const int i, const int r) const throw(Oracle::Error)
+{
+	const Column& c = col(i, "Column_Batch::date(const int, const int)");
+	if (c.type != Datetime)
+		throw Type_Error("Column_Batch::date(const int, const int)", "Column is not a date column");
+	if (r < 0 || r >= rows)
+	{
+		Value_Error e("Column_Batch::date(const int, const int)", "Row out of range");
+		e.desc << "row = " << r;
+		throw e;
+	}
+	if (c.ind[r] == -1)
+		return Date();
+	return Date(((OCIDate*) c.buf)[r]);
+}
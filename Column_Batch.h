@@ -0,0 +1,99 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Ora++ -- a C++ interface to Oracle based on the Oracle Call Interface
+// Copyright (C) 2000-1 James Edwin Cain <me@jimcain.net>
+// 
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or any
+// later version.
+// 
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef ORAPP_COLUMN_BATCH_H
+#define ORAPP_COLUMN_BATCH_H
+
+#include "Oracle.h"
+#include "Nullable.h"
+#include <vector>
+
+
+namespace Oracle
+{
+	class Date;
+	class Select_Stmt;
+
+	// A block of rows stored column by column, as returned by
+	// Select_Stmt::fetch_batch().  Each column is one contiguous array that
+	// OCI fills directly, so whole columns can be processed in tight loops.
+	class Column_Batch
+	{
+		public:
+			// types
+			enum col_t { Long, Double, String, Datetime };
+
+			// constructors/destructor
+			Column_Batch()					throw();
+			virtual ~Column_Batch()				throw();
+
+			// accessors
+			int nrows() const				throw()		// rows in this batch
+				{ return rows; }
+			int ncols() const				throw()		// number of columns
+				{ return cols.size(); }
+			int capacity() const				throw()		// max rows per batch
+				{ return cap; }
+			col_t type(const int) const			throw(Error);	// column type
+			const long* lng(const int) const		throw(Error);	// integer column
+			const double* dbl(const int) const		throw(Error);	// floating point column
+			const char* chars(const int) const		throw(Error);	// string column characters
+			const int* offsets(const int) const		throw(Error);	// string offsets (nrows() + 1)
+			const unsigned char* nulls(const int) const	throw(Error);	// null bitmap (bit set == NULL)
+			inline bool is_null(const int c, const int r) const throw(Error)
+				{ return (nulls(c)[r >> 3] >> (r & 7)) & 1; }
+			std::string str(const int, const int) const	throw(Error);	// string value
+			Date date(const int, const int) const		throw(Error);	// date value
+
+		protected:
+			// types
+			struct Column
+			{
+				col_t type;						// column type
+				int width;						// size of one value as fetched
+				char* buf;						// values
+				sb2* ind;						// null indicators
+				ub2* len;						// returned lengths
+				int* off;						// string offsets into buf
+				unsigned char* nulls;					// null bitmap
+			};
+
+			// protected implementors
+			void init_data(const Select_Stmt&, const int)	throw(Error);	// allocate from select list
+			void finish(const int)				throw();	// build offsets and bitmaps
+			void free_data()				throw();
+			const Column& col(const int, const char*) const	throw(Error);
+
+			// data members
+			std::vector<Column> cols;
+			int cap;							// rows allocated per column
+			int rows;							// rows in this batch
+
+		private:
+			// disallowed functions
+			Column_Batch(const Column_Batch&);
+			Column_Batch& operator=(const Column_Batch&);
+
+		friend class Select_Stmt;
+	};
+}
+
+#endif
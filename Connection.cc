@@ -24,6 +24,7 @@
 #include "Stmt.h"
 #include "Select_Stmt.h"
 #include "Non_Sel_Stmt.h"
+#include "Env.h"
 #include <oci.h>
 
 
@@ -31,18 +32,24 @@ Oracle::Env Oracle::Connection::env_;
 
 
 Oracle::Connection::Connection(const std::string& u, const std::string& p, const std::string& d) throw()
-	: uid(u), pw(p), sid(d), stat(not_connected), ses_h(0), svc_h(0), svr_h(0)
+	: uid(u), pw(p), sid(d), stat(not_connected), ses_h(0), svc_h(0), svr_h(0),
+	  pf_rows(0), pf_mem(0), cache_sz(0), cache_hit(0), cache_miss(0),
+	  cmode(Commit_Default), ac_rows(0), ac_ms(0), ac_pending(0), ac_t0(0), nb(false),
+	  batch_fail(0), t_attach(0), t_logon(0)
 {
-	env_h = env_.env();
-	err_h = env_.err();
+	env_h = 0;
+	err_h = 0;
 }
 
 
 Oracle::Connection::Connection(const std::string& s) throw()
-	: uid("/"), pw("/"), sid(""), stat(not_connected), ses_h(0), svc_h(0), svr_h(0)
+	: uid("/"), pw("/"), sid(""), stat(not_connected), ses_h(0), svc_h(0), svr_h(0),
+	  pf_rows(0), pf_mem(0), cache_sz(0), cache_hit(0), cache_miss(0),
+	  cmode(Commit_Default), ac_rows(0), ac_ms(0), ac_pending(0), ac_t0(0), nb(false),
+	  batch_fail(0), t_attach(0), t_logon(0)
 {
-	env_h = env_.env();
-	err_h = env_.err();
+	env_h = 0;
+	err_h = 0;
 
 	if (s == "/")
 		return;
@@ -78,6 +85,9 @@ Oracle::Connection::~Connection() throw(Oracle::Error)
 		close();
 	}
 	free_handles(); // close does this, but do it again just in case
+	delete batch_fail;
+	if (err_h)
+		OCIHandleFree((dvoid *)err_h, (ub4)OCI_HTYPE_ERROR);
 }
 
 
@@ -87,6 +97,7 @@ Oracle::Connection::open() throw(Oracle::Error)
 	if (stat == connected)
 		return;
 
+	double t = Env::now();
 	try
 	{
 		init_handles();
@@ -97,11 +108,14 @@ Oracle::Connection::open() throw(Oracle::Error)
 		free_handles();
 		throw;
 	}
+	t_attach = Env::now() - t;
 
+	t = Env::now();
 	try
 	{
 		log_on();
 		stat = connected;
+		t_logon = Env::now() - t;
 	}
 	catch(Error)
 	{
@@ -119,31 +133,40 @@ Oracle::Connection::prepare(const std::string& sql) throw(Oracle::Error)
 	if (stat == not_connected)
 		open();
 
-	// allocate a statement handle
-	OCIStmt* stmt_h;
-	if(OCIHandleAlloc(
-			(dvoid *) env_h,						// env handle
-			(dvoid **) &stmt_h,						// stmt handle returned
-			OCI_HTYPE_STMT,							// handle type to return
-			(size_t) 0,							// user-def memory size
-			(dvoid **) 0))							// user-def memory ptr
-		throw Error("Connection::prepare", "OCIHandleAlloc failed for statement [" + sql + "]");
-
 	// allocate space for the statement text
 	// the ptr to the statement text must be valid for the life of the statement
 	char* stmt_p = new char[sql.length() + 1];
 	sql.copy(stmt_p, sql.length());
 	stmt_p[sql.length()] = '\0';
 
-	// prepare the statement
-	if(OCIStmtPrepare(
-			stmt_h,								// statement handle
-			err_h,								// error handle
-			(text *) stmt_p,						// statement text
-			(ub4) strlen(stmt_p),						// statement length
-			(ub4) OCI_NTV_SYNTAX,						// syntax type
-			(ub4) OCI_DEFAULT))						// mode
-		throw OCI_Error("Connection::prepare", err_h);
+	OCIStmt* stmt_h;
+	if (cache_sz)
+		// get the statement from the cache, or prepare and add it
+		stmt_h = prepare_cached(stmt_p, "Connection::prepare");
+	else
+	{
+		// allocate a statement handle
+		if(OCIHandleAlloc(
+				(dvoid *) env_h,					// env handle
+				(dvoid **) &stmt_h,					// stmt handle returned
+				OCI_HTYPE_STMT,						// handle type to return
+				(size_t) 0,						// user-def memory size
+				(dvoid **) 0))						// user-def memory ptr
+			throw Error("Connection::prepare", "OCIHandleAlloc failed for statement [" + sql + "]");
+
+		// prepare the statement
+		if(OCIStmtPrepare(
+				stmt_h,							// statement handle
+				err_h,							// error handle
+				(text *) stmt_p,					// statement text
+				(ub4) strlen(stmt_p),					// statement length
+				(ub4) OCI_NTV_SYNTAX,					// syntax type
+				(ub4) OCI_DEFAULT))					// mode
+			throw OCI_Error("Connection::prepare", err_h);
+	}
+
+	// apply the default prefetch settings
+	apply_prefetch(stmt_h);
 	
 	// get the statement type
 	ub2 stmt_type;
@@ -155,13 +178,19 @@ Oracle::Connection::prepare(const std::string& sql) throw(Oracle::Error)
 			err_h))								// error handle
 		throw OCI_Error("Connection::prepare", err_h);
 
+	Stmt* s;
 	switch(stmt_type)
 	{
 		case OCI_STMT_SELECT:
-			return new Select_Stmt(stmt_h, stmt_p, svc_h, err_h);
+			s = new Select_Stmt(stmt_h, stmt_p, svc_h, err_h);
+			break;
 		default:	
-			return new Non_Sel_Stmt(stmt_h, stmt_p, svc_h, err_h);
+			s = new Non_Sel_Stmt(stmt_h, stmt_p, svc_h, err_h);
+			break;
 	}
+	s->cached = cache_sz != 0;
+	s->db_ = this;
+	return s;
 }
 
 
@@ -171,10 +200,21 @@ Oracle::Connection::rollback() throw(Oracle::Error)
 	if (stat == not_connected)
 		throw State_Error("Connection::rollback", "Not connected");
 
-	if(OCITransRollback(
+	// rows staged by batching statements are dropped
+	for (std::list<Non_Sel_Stmt*>::iterator i = batch_l.begin(); i != batch_l.end(); i++)
+		(*i)->discard();
+	ac_pending = 0;
+	delete batch_fail;
+	batch_fail = 0;
+
+	sword rc;
+	do
+		rc = OCITransRollback(
 			svc_h,							// service handle
 			err_h,							// error handle
-			(ub4) OCI_DEFAULT))					// flags
+			(ub4) OCI_DEFAULT);					// flags
+	while (rc == OCI_STILL_EXECUTING);
+	if (rc)
 		throw OCI_Error("Connection::rollback", err_h);
 }
 
@@ -185,11 +225,99 @@ Oracle::Connection::commit() throw(Oracle::Error)
 	if (stat == not_connected)
 		throw State_Error("Connection::commit", "Not connected");
 
-	if(OCITransCommit(
+	// rows a statement failed to send when it was closed are missing
+	// from the transaction, which must be rolled back instead
+	if (batch_fail)
+		batch_fail->raise();
+
+	// send rows staged by batching statements first
+	for (std::list<Non_Sel_Stmt*>::iterator i = batch_l.begin(); i != batch_l.end(); i++)
+		(*i)->flush();
+
+	ub4 flags = OCI_DEFAULT;
+	switch (cmode)
+	{
+		case Commit_Nowait:		flags = OCI_TRANS_WRITEIMMED | OCI_TRANS_WRITENOWAIT; break;
+		case Commit_Batch:		flags = OCI_TRANS_WRITEBATCH | OCI_TRANS_WRITEWAIT; break;
+		case Commit_Batch_Nowait:	flags = OCI_TRANS_WRITEBATCH | OCI_TRANS_WRITENOWAIT; break;
+		default:			break;
+	}
+
+	sword rc;
+	do
+		rc = OCITransCommit(
 			svc_h,							// service handle
 			err_h,							// error handle
-			(ub4) OCI_DEFAULT))					// flags
+			flags);							// flags
+	while (rc == OCI_STILL_EXECUTING);
+	if (rc)
 		throw OCI_Error("Connection::commit", err_h);
+	committed();
+}
+
+
+void
+Oracle::Connection::set_commit_mode(const commit_t m) throw()
+{
+	// The nowait and batch modes let commit() return before the redo is
+	// on disk, trading durability of the last few commits for latency.
+	cmode = m;
+}
+
+
+void
+Oracle::Connection::set_auto_commit(const int rows, const int ms) throw(Oracle::Error)
+{
+	if (rows < 0 || ms < 0)
+	{
+		Value_Error e("Connection::set_auto_commit", "Limits cannot be negative");
+		e.desc << "rows = " << rows << "; ms = " << ms;
+		throw e;
+	}
+
+	// The limits are checked as Non_Sel_Stmt objects execute; the commit
+	// rides on the execute that reaches a limit (OCI_COMMIT_ON_SUCCESS).
+	ac_rows = rows;
+	ac_ms = ms;
+	committed();
+}
+
+
+bool
+Oracle::Connection::commit_due(const int rows) const throw()
+{
+	return (ac_rows && ac_pending + rows >= ac_rows)
+		|| (ac_ms && (Env::now() - ac_t0) * 1e3 >= ac_ms);
+}
+
+
+bool
+Oracle::Connection::commit_alone(const Non_Sel_Stmt* s) const throw()
+{
+	// OCI_COMMIT_ON_SUCCESS would skip what commit() does first: raise a
+	// recorded batch failure and flush rows staged by other statements
+	if (batch_fail)
+		return false;
+	for (std::list<Non_Sel_Stmt*>::const_iterator i = batch_l.begin(); i != batch_l.end(); i++)
+		if (*i != s && (*i)->pending())
+			return false;
+	return true;
+}
+
+
+void
+Oracle::Connection::add_rows(const int rows) throw()
+{
+	ac_pending += rows;
+}
+
+
+void
+Oracle::Connection::committed() throw()
+{
+	ac_pending = 0;
+	if (ac_ms)
+		ac_t0 = Env::now();
 }
 
 
@@ -199,6 +327,9 @@ Oracle::Connection::close() throw(Oracle::Error)
 	if (stat == not_connected)
 		return;
 
+	// logging off and detaching are not polled
+	if (nb)
+		apply_nonblocking(false);
 	log_off();
 	detach_server();
 	free_handles();
@@ -206,9 +337,201 @@ Oracle::Connection::close() throw(Oracle::Error)
 }
 
 
+void
+Oracle::Connection::set_nonblocking(const bool on) throw(Oracle::Error)
+{
+	nb = on;
+	if (stat == connected)
+		apply_nonblocking(on);
+}
+
+
+void
+Oracle::Connection::apply_nonblocking(const bool on) throw(Oracle::Error)
+{
+	// the mode belongs to the server handle; a pooled session has none of
+	// its own, so take it from the service context
+	OCIServer* h;
+	if (OCIAttrGet(	(dvoid *) svc_h,					// service handle
+			(ub4) OCI_HTYPE_SVCCTX,					// handle type
+			(dvoid *) &h,						// returned server handle
+			(ub4 *) 0,						// output size (0==default)
+			(ub4) OCI_ATTR_SERVER,					// attribute to return
+			err_h))							// error handle
+		throw OCI_Error("Connection::apply_nonblocking", err_h, __FILE__, __LINE__);
+
+	// setting the attribute toggles the mode, so only set it on a change
+	ub1 cur;
+	if (OCIAttrGet(	(dvoid *) h,
+			(ub4) OCI_HTYPE_SERVER,
+			(dvoid *) &cur,
+			(ub4 *) 0,
+			(ub4) OCI_ATTR_NONBLOCKING_MODE,
+			err_h))
+		throw OCI_Error("Connection::apply_nonblocking", err_h, __FILE__, __LINE__);
+	if ((cur != 0) != on && OCIAttrSet(
+			(dvoid *) h,					// target
+			(ub4) OCI_HTYPE_SERVER,					// target type
+			(dvoid *) 0,						// value (ignored)
+			(ub4) 0,						// size of attribute
+			(ub4) OCI_ATTR_NONBLOCKING_MODE,			// attribute type
+			err_h))							// error handle
+		throw OCI_Error("Connection::apply_nonblocking", err_h, __FILE__, __LINE__);
+}
+
+
+void
+Oracle::Connection::set_prefetch(const int rows, const int mem) throw()
+{
+	// applies to statements created after this call
+	pf_rows = rows;
+	pf_mem = mem;
+}
+
+
+void
+Oracle::Connection::apply_prefetch(OCIStmt* stmt_h) throw(Oracle::Error)
+{
+	// zero leaves the OCI default in place
+	ub4 n;
+	if (pf_rows)
+	{
+		n = pf_rows;
+		if (OCIAttrSet(	(dvoid *) stmt_h,				// statement handle
+				(ub4) OCI_HTYPE_STMT,				// handle type
+				(dvoid *) &n,					// rows to prefetch
+				(ub4) 0,					// size of attribute
+				(ub4) OCI_ATTR_PREFETCH_ROWS,			// attribute type
+				err_h))						// error handle
+			throw OCI_Error("Connection::apply_prefetch", err_h, __FILE__, __LINE__);
+	}
+	if (pf_mem)
+	{
+		n = pf_mem;
+		if (OCIAttrSet(	(dvoid *) stmt_h,
+				(ub4) OCI_HTYPE_STMT,
+				(dvoid *) &n,
+				(ub4) 0,
+				(ub4) OCI_ATTR_PREFETCH_MEMORY,
+				err_h))
+			throw OCI_Error("Connection::apply_prefetch", err_h, __FILE__, __LINE__);
+	}
+}
+
+
+void
+Oracle::Connection::set_stmt_cache_size(const int n) throw(Oracle::Error)
+{
+	if (n < 0)
+	{
+		Value_Error e("Connection::set_stmt_cache_size", "Cache size cannot be negative");
+		e.desc << "size = " << n;
+		throw e;
+	}
+
+	// Statements prepared while the cache is on are released to it when
+	// closed; with a size of zero, handles are allocated and freed as before.
+	cache_sz = n;
+	if (stat == connected)
+		apply_stmt_cache();
+}
+
+
+void
+Oracle::Connection::add_batch(Non_Sel_Stmt* s) throw()
+{
+	batch_l.push_back(s);
+}
+
+
+void
+Oracle::Connection::remove_batch(Non_Sel_Stmt* s) throw()
+{
+	batch_l.remove(s);
+}
+
+
+void
+Oracle::Connection::batch_failed(const Error& e) throw()
+{
+	// the first failure is kept until rollback()
+	if (!batch_fail)
+		batch_fail = e.clone();
+}
+
+
+void
+Oracle::Connection::apply_stmt_cache() throw(Oracle::Error)
+{
+	ub4 n = cache_sz;
+	if (OCIAttrSet(	(dvoid *) svc_h,					// service handle
+			(ub4) OCI_HTYPE_SVCCTX,					// handle type
+			(dvoid *) &n,						// statements to cache
+			(ub4) 0,						// size of attribute
+			(ub4) OCI_ATTR_STMTCACHESIZE,				// attribute type
+			err_h))							// error handle
+		throw OCI_Error("Connection::apply_stmt_cache", err_h, __FILE__, __LINE__);
+}
+
+
+OCIStmt*
+Oracle::Connection::prepare_cached(const char* sql, const std::string& module) throw(Oracle::Error)
+{
+	OCIStmt* stmt_h = 0;
+
+	// look in the cache only, so that hits and misses can be counted
+	if (OCIStmtPrepare2(
+			svc_h,							// service handle
+			&stmt_h,						// stmt handle returned
+			err_h,							// error handle
+			(CONST text *) sql,					// statement text (cache key)
+			(ub4) strlen(sql),					// statement length
+			(CONST text *) 0,					// tag
+			(ub4) 0,						// tag length
+			(ub4) OCI_NTV_SYNTAX,					// syntax type
+			(ub4) OCI_PREP2_CACHE_SEARCHONLY) == OCI_SUCCESS)	// mode
+	{
+		cache_hit++;
+		return stmt_h;
+	}
+	cache_miss++;
+
+	// prepare the statement; it is added to the cache when released
+	stmt_h = 0;
+	if (OCIStmtPrepare2(
+			svc_h,							// service handle
+			&stmt_h,						// stmt handle returned
+			err_h,							// error handle
+			(CONST text *) sql,					// statement text
+			(ub4) strlen(sql),					// statement length
+			(CONST text *) 0,					// tag
+			(ub4) 0,						// tag length
+			(ub4) OCI_NTV_SYNTAX,					// syntax type
+			(ub4) OCI_DEFAULT))					// mode
+	{
+		OCI_Error e(module, err_h);
+		e.desc << "statement = {" << sql << "}";
+		throw e;
+	}
+	return stmt_h;
+}
+
+
 void
 Oracle::Connection::init_handles() throw(Oracle::Error)
 {
+	// Each Connection has its own error handle, which it shares with its
+	// statements, so Connections used on different threads do not contend.
+	// It outlives close() so that statements can still report errors.
+	env_h = env_.env();
+	if (!err_h && OCIHandleAlloc(
+			(dvoid *) env_h,					// env handle
+			(dvoid **) &err_h,					// ptr to handle alloced
+			(ub4) OCI_HTYPE_ERROR,					// handle type
+			(size_t) 0,						// user memory size
+			(dvoid **) 0))						// user memory ptr
+		throw Error("Connection::init_handles", "Could not allocate an error handle");
+
 	// allocate a service handle
 	if (OCIHandleAlloc(
 			(dvoid *) env_h,					// env handle
@@ -298,6 +621,12 @@ Oracle::Connection::log_on() throw(Oracle::Error)
 			(ub4) OCI_ATTR_SESSION,
 			err_h))
 		throw OCI_Error("Connection::log_on", err_h, __FILE__, __LINE__);
+
+	// enable the statement cache if one was requested
+	if (cache_sz)
+		apply_stmt_cache();
+	if (nb)
+		apply_nonblocking(true);
 }
 
 
@@ -24,23 +24,27 @@
 
 #include "Oracle.h"
 #include "Env.h"
+#include <list>
 
 class OCIEnv;
 class OCIServer;
 class OCISvcCtx;
 class OCISession;
 class OCIError;
+class OCIStmt;
 
 
 namespace Oracle
 {
 	class Stmt;
+	class Non_Sel_Stmt;
 
 	class Connection
 	{
 		public:
 			// types
 			enum status_t { not_connected, connected };
+			enum commit_t { Commit_Default, Commit_Nowait, Commit_Batch, Commit_Batch_Nowait };
 
 			// constructors/destructor
 			Connection(
@@ -56,6 +60,37 @@ namespace Oracle
 			virtual void rollback()				throw(Error);	// roll back transaction
 			virtual void commit()				throw(Error);	// commit transaction
 			virtual void close()				throw(Error);	// detach from server
+			void set_prefetch(						// default prefetch for new statements
+				const int,						// rows (0==OCI default)
+				const int = 0)				throw();	// memory in bytes (0==OCI default)
+			void set_stmt_cache_size(const int)		throw(Error);	// statements cached (0==no cache)
+			void set_commit_mode(const commit_t)		throw();	// redo write mode for commit()
+			void set_auto_commit(						// commit as statements execute
+				const int,						// every n rows (0==never)
+				const int = 0)				throw(Error);	// every t ms (0==never)
+			void set_nonblocking(const bool)		throw(Error);	// OCI calls may return before completion
+
+			// accessors
+			int prefetch_rows() const			throw()		// default prefetch rows
+				{ return pf_rows; }
+			int prefetch_memory() const			throw()		// default prefetch memory
+				{ return pf_mem; }
+			int stmt_cache_size() const			throw()		// statements cached
+				{ return cache_sz; }
+			long cache_hits() const				throw()		// prepares found in cache
+				{ return cache_hit; }
+			long cache_misses() const			throw()		// prepares not found in cache
+				{ return cache_miss; }
+			commit_t commit_mode() const			throw()		// redo write mode for commit()
+				{ return cmode; }
+			long uncommitted() const			throw()		// rows executed since last commit
+				{ return ac_pending; }
+			bool nonblocking() const			throw()		// non-blocking mode requested
+				{ return nb; }
+			double attach_secs() const			throw()		// time taken to attach in open()
+				{ return t_attach; }
+			double logon_secs() const			throw()		// time taken to log on in open()
+				{ return t_logon; }
 
 		protected:
 			// protected functions
@@ -73,6 +108,19 @@ namespace Oracle
 			void log_off()					throw(Error);
 			void detach_server()				throw(Error);
 			void free_handles()				throw();
+			void apply_prefetch(OCIStmt*)			throw(Error);	// set default prefetch on stmt
+			void apply_stmt_cache()				throw(Error);	// set cache size on session
+			void apply_nonblocking(const bool)		throw(Error);	// set mode on server handle
+			bool commit_due(const int) const		throw();	// auto-commit limit reached?
+			bool commit_alone(const Non_Sel_Stmt*) const	throw();	// commit can ride on this execute?
+			void add_rows(const int)			throw();	// count rows executed
+			void committed()				throw();	// restart auto-commit counts
+			void add_batch(Non_Sel_Stmt*)			throw();	// flush on commit
+			void remove_batch(Non_Sel_Stmt*)		throw();
+			void batch_failed(const Error&)			throw();	// staged rows lost on close
+			OCIStmt* prepare_cached(			// get a prepared handle from the cache
+				const char*,						// statement text
+				const std::string&)			throw(Error);	// calling function
 		
 			// data members
 			std::string uid;						// username
@@ -84,6 +132,21 @@ namespace Oracle
 			OCIServer* svr_h;						// server handle
 			OCISvcCtx* svc_h;						// service context handle
 			OCISession* ses_h;						// session handle
+			int pf_rows;							// default prefetch rows
+			int pf_mem;							// default prefetch memory
+			int cache_sz;							// statement cache size
+			long cache_hit;							// prepares found in cache
+			long cache_miss;						// prepares not found in cache
+			std::list<Non_Sel_Stmt*> batch_l;				// batching statements
+			commit_t cmode;							// redo write mode for commit()
+			int ac_rows;							// auto-commit row limit
+			int ac_ms;							// auto-commit time limit
+			long ac_pending;						// rows since last commit
+			double ac_t0;							// time of last commit
+			bool nb;							// non-blocking mode
+			Error* batch_fail;						// raised by commit() until rollback()
+			double t_attach;						// secs to attach
+			double t_logon;							// secs to log on
 
 		private:
 			// disallowed functions
@@ -94,6 +157,9 @@ namespace Oracle
 			static Env env_;						// initializes OCI environment
 
 		friend class Stmt;
+		friend class Non_Sel_Stmt;
+		friend class Direct_Load;
+		friend class Bulk_Open;
 	};
 }
 
@@ -0,0 +1,367 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Ora++ -- a C++ interface to Oracle based on the Oracle Call Interface
+// Copyright (C) 2000-1 James Edwin Cain <me@jimcain.net>
+// 
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or any
+// later version.
+// 
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Connection_Pool.h"
+#include "Env.h"
+#include <oci.h>
+
+
+Oracle::Env Oracle::Connection_Pool::env_;
+
+
+Oracle::Connection_Pool::Connection_Pool(const std::string& u, const std::string& p, const std::string& d,
+	const int mn, const int mx, const int inc) throw(Oracle::Error)
+	: uid(u), pw(p), sid(d), min_n(mn), max_n(mx), incr_n(inc), pool_h(0), err_h(0),
+	  name_p(0), name_len(0), ngets(0), ncreated(0), high(0), t_wait(0), t0(Env::now())
+{
+	if (mn < 0 || mx < 1 || mn > mx || inc < 1)
+	{
+		Value_Error e("Connection_Pool::Connection_Pool", "Invalid pool size");
+		e.desc << "min = " << mn << "; max = " << mx << "; increment = " << inc;
+		throw e;
+	}
+
+	if (OCIHandleAlloc(
+			(dvoid *) env_.env(),					// env handle
+			(dvoid **) &err_h,					// ptr to handle alloced
+			(ub4) OCI_HTYPE_ERROR,					// handle type
+			(size_t) 0,						// user memory size
+			(dvoid **) 0)
+		|| OCIHandleAlloc(
+			(dvoid *) env_.env(),
+			(dvoid **) &pool_h,
+			(ub4) OCI_HTYPE_SPOOL,
+			(size_t) 0,
+			(dvoid **) 0))
+	{
+		if (err_h)
+			OCIHandleFree((dvoid *)err_h, (ub4)OCI_HTYPE_ERROR);
+		throw Error("Connection_Pool::Connection_Pool", "Could not allocate pool handles");
+	}
+
+	// every session uses the same credentials, so the pool is homogeneous
+	// and each session keeps its own statement cache
+	text* name;
+	ub4 len;
+	if (OCISessionPoolCreate(
+			env_.env(),						// env handle
+			err_h,							// error handle
+			pool_h,							// pool handle
+			&name,							// pool name returned
+			&len,							// length of pool name
+			(const text *) sid.c_str(),				// connect string
+			(ub4) sid.length(),					// length of connect string
+			(ub4) min_n,						// min sessions
+			(ub4) max_n,						// max sessions
+			(ub4) incr_n,						// sessions added at a time
+			(text *) uid.c_str(),					// username
+			(ub4) uid.length(),					// length of username
+			(text *) pw.c_str(),					// password
+			(ub4) pw.length(),					// length of password
+			(ub4) OCI_SPC_HOMOGENEOUS | OCI_SPC_STMTCACHE))		// mode
+	{
+		OCI_Error e("Connection_Pool::Connection_Pool", err_h, __FILE__, __LINE__);
+		e.desc << "database = {" << sid << "}; user = {" << uid << "}";
+		OCIHandleFree((dvoid *)pool_h, (ub4)OCI_HTYPE_SPOOL);
+		OCIHandleFree((dvoid *)err_h, (ub4)OCI_HTYPE_ERROR);
+		throw e;
+	}
+	name_p = (char *) name;
+	name_len = len;
+
+	// the sessions opened up front count as creations
+	pthread_mutex_init(&mtx, 0);
+	high = ncreated = attr(OCI_ATTR_SPOOL_OPEN_COUNT, err_h);
+}
+
+
+Oracle::Connection_Pool::~Connection_Pool() throw()
+{
+	try
+	{
+		close();
+	}
+	catch (Error&)
+	{
+	}
+	if (err_h)
+		OCIHandleFree((dvoid *)err_h, (ub4)OCI_HTYPE_ERROR);
+	pthread_mutex_destroy(&mtx);
+}
+
+
+void
+Oracle::Connection_Pool::close() throw(Oracle::Error)
+{
+	if (!pool_h)
+		return;
+
+	// sessions still borrowed are closed as well
+	sword rc = OCISessionPoolDestroy(
+			pool_h,							// pool handle
+			err_h,							// error handle
+			(ub4) OCI_SPD_FORCE);					// mode
+	OCIHandleFree((dvoid *)pool_h, (ub4)OCI_HTYPE_SPOOL);
+	pool_h = 0;
+	if (rc)
+		throw OCI_Error("Connection_Pool::close", err_h);
+}
+
+
+void
+Oracle::Connection_Pool::set_timeout(const int secs) throw(Oracle::Error)
+{
+	if (secs < 0)
+	{
+		Value_Error e("Connection_Pool::set_timeout", "Timeout cannot be negative");
+		e.desc << "secs = " << secs;
+		throw e;
+	}
+
+	ub4 n = secs;
+	if (OCIAttrSet(	(dvoid *) pool_h,					// pool handle
+			(ub4) OCI_HTYPE_SPOOL,					// handle type
+			(dvoid *) &n,						// idle timeout
+			(ub4) sizeof(n),					// size of attribute
+			(ub4) OCI_ATTR_SPOOL_TIMEOUT,				// attribute type
+			err_h))							// error handle
+		throw OCI_Error("Connection_Pool::set_timeout", err_h, __FILE__, __LINE__);
+}
+
+
+void
+Oracle::Connection_Pool::set_nowait(const bool on) throw(Oracle::Error)
+{
+	ub1 mode = on ? OCI_SPOOL_ATTRVAL_NOWAIT : OCI_SPOOL_ATTRVAL_WAIT;
+	if (OCIAttrSet(	(dvoid *) pool_h,					// pool handle
+			(ub4) OCI_HTYPE_SPOOL,					// handle type
+			(dvoid *) &mode,					// get mode
+			(ub4) sizeof(mode),					// size of attribute
+			(ub4) OCI_ATTR_SPOOL_GETMODE,				// attribute type
+			err_h))							// error handle
+		throw OCI_Error("Connection_Pool::set_nowait", err_h, __FILE__, __LINE__);
+}
+
+
+int
+Oracle::Connection_Pool::attr(const int a, OCIError* e_h) const throw(Oracle::Error)
+{
+	if (!pool_h)
+		throw State_Error("Connection_Pool::attr", "Pool is closed");
+
+	ub4 n = 0;
+	if (OCIAttrGet(	(dvoid *) pool_h,					// pool handle
+			(ub4) OCI_HTYPE_SPOOL,					// handle type
+			(dvoid *) &n,						// returned value
+			(ub4 *) 0,						// output size (0==default)
+			(ub4) a,						// attribute to return
+			e_h))							// error handle
+		throw OCI_Error("Connection_Pool::attr", e_h, __FILE__, __LINE__);
+	return n;
+}
+
+
+int
+Oracle::Connection_Pool::shared_attr(const int a) const throw(Oracle::Error)
+{
+	// callers in any thread share the pool's error handle
+	pthread_mutex_lock(&mtx);
+	try
+	{
+		int n = attr(a, err_h);
+		pthread_mutex_unlock(&mtx);
+		return n;
+	}
+	catch (Error&)
+	{
+		pthread_mutex_unlock(&mtx);
+		throw;
+	}
+}
+
+
+int
+Oracle::Connection_Pool::busy() const throw(Oracle::Error)
+{
+	return shared_attr(OCI_ATTR_SPOOL_BUSY_COUNT);
+}
+
+
+int
+Oracle::Connection_Pool::open_count() const throw(Oracle::Error)
+{
+	return shared_attr(OCI_ATTR_SPOOL_OPEN_COUNT);
+}
+
+
+int
+Oracle::Connection_Pool::idle() const throw(Oracle::Error)
+{
+	return open_count() - busy();
+}
+
+
+double
+Oracle::Connection_Pool::creations_per_sec() const throw()
+{
+	double t = Env::now() - t0;
+	return t > 0 ? ncreated / t : 0;
+}
+
+
+OCISvcCtx*
+Oracle::Connection_Pool::get(OCIError* e_h) throw(Oracle::Error)
+{
+	if (!pool_h)
+		throw State_Error("Connection_Pool::get", "Pool is closed");
+
+	double t = Env::now();
+	OCISvcCtx* svc_h = 0;
+	if (OCISessionGet(
+			env_.env(),						// env handle
+			e_h,							// error handle
+			&svc_h,							// service handle returned
+			(OCIAuthInfo *) 0,					// credentials (pool's own)
+			(text *) name_p,					// pool name
+			(ub4) name_len,						// length of pool name
+			(const text *) 0,					// tag
+			(ub4) 0,						// length of tag
+			(text **) 0,						// tag returned
+			(ub4 *) 0,						// length of tag returned
+			(boolean *) 0,						// tag found
+			(ub4) OCI_SESSGET_SPOOL))				// mode
+		throw OCI_Error("Connection_Pool::get", e_h, __FILE__, __LINE__);
+	t = Env::now() - t;
+
+	// the pool does not report creations, so count growth in open sessions
+	int n = attr(OCI_ATTR_SPOOL_OPEN_COUNT, e_h);
+	pthread_mutex_lock(&mtx);
+	ngets++;
+	t_wait += t;
+	if (n > high)
+	{
+		ncreated += n - high;
+		high = n;
+	}
+	pthread_mutex_unlock(&mtx);
+	return svc_h;
+}
+
+
+void
+Oracle::Connection_Pool::release(OCISvcCtx* svc_h, OCIError* e_h, const bool drop) throw(Oracle::Error)
+{
+	if (OCISessionRelease(
+			svc_h,							// service handle
+			e_h,							// error handle
+			(text *) 0,						// tag
+			(ub4) 0,						// length of tag
+			(ub4) (drop ? OCI_SESSRLS_DROPSESS : OCI_DEFAULT)))	// mode
+		throw OCI_Error("Connection_Pool::release", e_h, __FILE__, __LINE__);
+
+	// a dropped session lowers the mark, so a replacement counts as created
+	if (drop)
+	{
+		int n = attr(OCI_ATTR_SPOOL_OPEN_COUNT, e_h);
+		pthread_mutex_lock(&mtx);
+		high = n;
+		pthread_mutex_unlock(&mtx);
+	}
+}
+
+
+Oracle::Pooled_Connection::Pooled_Connection(Connection_Pool& p) throw(Oracle::Error)
+	: Connection(p.uid, p.pw, p.sid), pool(p), t_wait(0)
+{
+	open();
+}
+
+
+Oracle::Pooled_Connection::~Pooled_Connection() throw(Oracle::Error)
+{
+	// ~Connection would log off and detach, so return the session here
+	if (stat == connected)
+		close();
+}
+
+
+void
+Oracle::Pooled_Connection::open() throw(Oracle::Error)
+{
+	if (stat == connected)
+		return;
+
+	env_h = Connection_Pool::env_.env();
+	if (!err_h && OCIHandleAlloc(
+			(dvoid *) env_h,					// env handle
+			(dvoid **) &err_h,					// ptr to handle alloced
+			(ub4) OCI_HTYPE_ERROR,					// handle type
+			(size_t) 0,						// user memory size
+			(dvoid **) 0))						// user memory ptr
+		throw Error("Pooled_Connection::open", "Could not allocate an error handle");
+
+	double t = Env::now();
+	svc_h = pool.get(err_h);
+	t_wait = Env::now() - t;
+	stat = connected;
+
+	if (cache_sz)
+		apply_stmt_cache();
+	if (nb)
+		apply_nonblocking(true);
+}
+
+
+void
+Oracle::Pooled_Connection::close() throw(Oracle::Error)
+{
+	give_back(false);
+}
+
+
+void
+Oracle::Pooled_Connection::drop() throw(Oracle::Error)
+{
+	give_back(true);
+}
+
+
+void
+Oracle::Pooled_Connection::give_back(const bool drop) throw(Oracle::Error)
+{
+	if (stat == not_connected)
+		return;
+
+	// the next borrower must not inherit this transaction; a dropped
+	// session's transaction ends with the session
+	if (!drop)
+		rollback();
+
+	// the session goes back in blocking mode
+	if (nb)
+		apply_nonblocking(false);
+
+	// the service handle belongs to the pool, so it is not freed here
+	OCISvcCtx* h = svc_h;
+	svc_h = 0;
+	stat = not_connected;
+	pool.release(h, err_h, drop);
+}
@@ -0,0 +1,151 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Ora++ -- a C++ interface to Oracle based on the Oracle Call Interface
+// Copyright (C) 2000-1 James Edwin Cain <me@jimcain.net>
+// 
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or any
+// later version.
+// 
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef ORAPP_CONNECTION_POOL_H
+#define ORAPP_CONNECTION_POOL_H
+
+#include "Oracle.h"
+#include "Env.h"
+#include "Connection.h"
+#include <pthread.h>
+
+class OCISPool;
+
+
+namespace Oracle
+{
+	// A pool of sessions kept open on an OCI session pool.  Borrowing a
+	// session with a Pooled_Connection takes no round trip once the pool
+	// has grown to meet demand.  The pool is safe to share between threads.
+	class Connection_Pool
+	{
+		public:
+			// constructors/destructor
+			Connection_Pool(
+				const std::string&,					// username
+				const std::string&,					// password
+				const std::string& = "",				// database
+				const int = 1,						// min sessions
+				const int = 10,						// max sessions
+				const int = 1)				throw(Error);	// sessions added at a time
+			virtual ~Connection_Pool()			throw();
+
+			// implementors
+			void set_timeout(const int)			throw(Error);	// idle secs before shrinking (0==never)
+			void set_nowait(const bool)			throw(Error);	// fail instead of waiting when all busy
+			void close()					throw(Error);	// destroy pool
+
+			// accessors
+			int min() const					throw()		// min sessions
+				{ return min_n; }
+			int max() const					throw()		// max sessions
+				{ return max_n; }
+			int increment() const				throw()		// sessions added at a time
+				{ return incr_n; }
+			int busy() const				throw(Error);	// sessions borrowed
+			int open_count() const				throw(Error);	// sessions open
+			int idle() const				throw(Error);	// sessions open, not borrowed
+			long gets() const				throw()		// sessions borrowed so far
+				{ return ngets; }
+			long creations() const				throw()		// sessions the pool has opened
+				{ return ncreated; }
+			double creations_per_sec() const		throw();	// creations / secs since pool created
+			double wait_secs() const			throw()		// total time spent borrowing
+				{ return t_wait; }
+			double avg_wait_secs() const			throw()		// wait_secs / gets
+				{ return ngets ? t_wait / ngets : 0; }
+
+		protected:
+			// protected implementors
+			OCISvcCtx* get(OCIError*)			throw(Error);	// borrow a session
+			void release(							// return a session
+				OCISvcCtx*,						// service handle from get()
+				OCIError*,						// error handle
+				const bool)				throw(Error);	// drop instead of keeping
+			int attr(const int, OCIError*) const		throw(Error);	// get a ub4 pool attribute
+			int shared_attr(const int) const		throw(Error);	// attr() with err_h, serialized
+
+			// data members
+			std::string uid;						// username
+			std::string pw;							// password
+			std::string sid;						// db name
+			int min_n;							// min sessions
+			int max_n;							// max sessions
+			int incr_n;							// sessions added at a time
+			OCISPool* pool_h;						// session pool handle
+			OCIError* err_h;						// error handle for pool calls
+			char* name_p;							// pool name returned by OCI
+			int name_len;							// length of pool name
+			mutable pthread_mutex_t mtx;					// guards the statistics and err_h
+			long ngets;							// sessions borrowed
+			long ncreated;							// sessions opened
+			int high;							// most sessions seen open
+			double t_wait;							// time spent in get()
+			double t0;							// time pool was created
+
+		private:
+			// disallowed functions
+			Connection_Pool(const Connection_Pool&);
+			Connection_Pool& operator=(const Connection_Pool&);
+
+			// data members
+			static Env env_;						// initializes OCI environment
+
+		friend class Pooled_Connection;
+	};
+
+
+	// A Connection whose session is borrowed from a Connection_Pool when
+	// constructed and returned when destroyed (or closed).  It can be passed
+	// anywhere a Connection is expected.  Uncommitted work is rolled back
+	// before the session is returned.
+	class Pooled_Connection: public Connection
+	{
+		public:
+			// constructors/destructor
+			Pooled_Connection(Connection_Pool&)		throw(Error);	// borrows a session
+			virtual ~Pooled_Connection()			throw(Error);	// returns it
+
+			// implementors
+			virtual void open()				throw(Error);	// borrow again after close()
+			virtual void close()				throw(Error);	// return session to pool
+			void drop()					throw(Error);	// close the session, don't reuse it
+
+			// accessors
+			double wait_secs() const			throw()		// time taken to borrow
+				{ return t_wait; }
+
+		protected:
+			// protected implementors
+			void give_back(const bool)			throw(Error);	// release, optionally dropping
+
+			// data members
+			Connection_Pool& pool;
+			double t_wait;
+
+		private:
+			// disallowed functions
+			Pooled_Connection(const Pooled_Connection&);
+			Pooled_Connection& operator=(const Pooled_Connection&);
+	};
+}
+
+#endif
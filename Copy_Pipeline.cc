@@ -0,0 +1,387 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Ora++ -- a C++ interface to Oracle based on the Oracle Call Interface
+// Copyright (C) 2000-1 James Edwin Cain <me@jimcain.net>
+// 
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or any
+// later version.
+// 
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Oracle.h"
+#include "Copy_Pipeline.h"
+#include "Connection.h"
+#include "Select_Stmt.h"
+#include "Non_Sel_Stmt.h"
+#include "Rowtype.h"
+#include "Nullable_Array.h"
+#include "Varchar.h"
+#include "Number.h"
+#include "Date.h"
+#include "Env.h"
+#include <oci.h>
+
+
+Oracle::Copy_Pipeline::Copy_Pipeline(Select_Stmt& s, Non_Sel_Stmt& d, Connection& db) throw(Oracle::Error)
+	: src(s), dst(d), dst_db(db), xform(0), batch_rows(500), commit_every(0),
+	  read_done(false), stopping(false), read_err(0),
+	  nread(0), nwritten(0), nbatches(0), t_run(0), t_fetch_wait(0), t_write_wait(0)
+{
+	for (int k=0; k < 2; k++)
+	{
+		buf[k].rows = 0;
+		buf[k].full = false;
+	}
+	pthread_mutex_init(&mtx, 0);
+	pthread_cond_init(&cv, 0);
+}
+
+
+Oracle::Copy_Pipeline::~Copy_Pipeline() throw()
+{
+	free_buffers();
+	delete read_err;
+	pthread_cond_destroy(&cv);
+	pthread_mutex_destroy(&mtx);
+}
+
+
+void
+Oracle::Copy_Pipeline::set_batch_rows(const int n) throw(Oracle::Error)
+{
+	if (n < 1)
+	{
+		Value_Error e("Copy_Pipeline::set_batch_rows(const int)", "Batch size must be at least 1");
+		e.desc << "size = " << n;
+		throw e;
+	}
+	batch_rows = n;
+}
+
+
+void
+Oracle::Copy_Pipeline::set_commit_every(const int n) throw(Oracle::Error)
+{
+	if (n < 0)
+	{
+		Value_Error e("Copy_Pipeline::set_commit_every(const int)", "Commit interval cannot be negative");
+		e.desc << "rows = " << n;
+		throw e;
+	}
+	commit_every = n;
+}
+
+
+void
+Oracle::Copy_Pipeline::set_transform(Batch_Transform* t) throw()
+{
+	xform = t;
+}
+
+
+void
+Oracle::Copy_Pipeline::init_buffers() throw(Oracle::Error)
+{
+	// execute the source if necessary; its columns must not be defined yet
+	if (src.st < Stmt::Executed)
+		src.exec();
+	if (src.st > Stmt::Executed || src.def_l.size())
+	{
+		State_Error e("Copy_Pipeline::run()", "Source columns have already been defined");
+		e.desc << "statement = {" << src.str() << "}";
+		throw e;
+	}
+	if (dst.st == Stmt::Initialized)
+		dst.prepare();
+
+	// a Rowtype describes the select list; each column gets a matching array
+	Rowtype row(src);
+	for (int k=0; k < 2; k++)
+		for (int i=0; i < row.ncols(); i++)
+		{
+			Nullable_Array* a;
+			if (dynamic_cast<Varchar*>(&row[i]))
+				a = new Varchar_Array(batch_rows, row[i].maxsize() - 1);
+			else if (dynamic_cast<Number*>(&row[i]))
+				a = new Number_Array(batch_rows);
+			else
+				a = new Date_Array(batch_rows);
+			buf[k].cols.push_back(a);
+		}
+}
+
+
+void
+Oracle::Copy_Pipeline::free_buffers() throw()
+{
+	for (int k=0; k < 2; k++)
+	{
+		for (int i=0; i < buf[k].cols.size(); i++)
+			delete buf[k].cols[i];
+		buf[k].cols.clear();
+	}
+}
+
+
+void
+Oracle::Copy_Pipeline::define(Buffer& b) throw(Oracle::Error)
+{
+	// defining a position again replaces the earlier define
+	for (int i=0; i < b.cols.size(); i++)
+	{
+		Nullable_Array& a = *b.cols[i];
+		OCIDefine* def_h = 0;
+		if (OCIDefineByPos(
+				src.stmt_h,					// stmt handle
+				&def_h,						// define handle returned
+				src.err_h,					// error handle
+				(ub4) i + 1,					// position (one-based)
+				(dvoid*) a.data(),				// output buffer
+				(sb4) a.width(),				// size of one value
+				(ub2) a.sqlt(),					// external data type
+				(dvoid*) a.ind,					// indicators
+				a.len,						// returned lengths
+				(ub2*) 0,					// array of return codes
+				(ub4) OCI_DEFAULT)
+			|| OCIDefineArrayOfStruct(
+				def_h,						// define handle
+				src.err_h,					// error handle
+				(ub4) a.width(),				// skip between values
+				(ub4) sizeof(sb2),				// skip between indicators
+				(ub4) sizeof(ub2),				// skip between lengths
+				(ub4) 0))					// skip between return codes
+		{
+			OCI_Error e("Copy_Pipeline::define", src.err_h);
+			e.desc << "statement = {" << src.str() << "}; position = " << i + 1;
+			throw e;
+		}
+	}
+	src.st = Stmt::Defined;
+}
+
+
+void
+Oracle::Copy_Pipeline::bind(Buffer& b) throw(Oracle::Error)
+{
+	// binding a position again replaces the earlier bind
+	for (int i=0; i < b.cols.size(); i++)
+	{
+		Nullable_Array& a = *b.cols[i];
+		OCIBind* bind_h = 0;
+		if (OCIBindByPos(dst.stmt_h,
+				&bind_h,
+				dst.err_h,
+				(ub4) i + 1,
+				(dvoid*) a.data(),
+				(sb4) a.width(),
+				(ub2) a.sqlt(),
+				(dvoid*) a.ind,
+				(ub2*) a.len,
+				(ub2*) 0,
+				(ub4) 0,
+				(ub4*) 0,
+				OCI_DEFAULT)
+			|| OCIBindArrayOfStruct(
+				bind_h,						// bind handle
+				dst.err_h,					// error handle
+				(ub4) a.width(),				// value skip
+				(ub4) sizeof(sb2),				// indicator skip
+				(ub4) sizeof(ub2),				// length skip
+				(ub4) 0))					// return code skip
+		{
+			OCI_Error e("Copy_Pipeline::bind", dst.err_h);
+			e.desc << "statement = {" << dst.str() << "}; position = " << i + 1;
+			throw e;
+		}
+	}
+	dst.arr_rows = batch_rows;
+}
+
+
+void*
+Oracle::Copy_Pipeline::thread_main(void* arg)
+{
+	((Copy_Pipeline*) arg)->read();
+	return 0;
+}
+
+
+void
+Oracle::Copy_Pipeline::read() throw()
+{
+	try
+	{
+		ub4 prev = 0;
+		for (int k=0; ; k = 1 - k)
+		{
+			// wait for the writer to finish with this buffer
+			double t = Env::now();
+			pthread_mutex_lock(&mtx);
+			while (buf[k].full && !stopping)
+				pthread_cond_wait(&cv, &mtx);
+			bool stop = stopping;
+			pthread_mutex_unlock(&mtx);
+			t_fetch_wait += Env::now() - t;
+			if (stop)
+				break;
+
+			define(buf[k]);
+			sword rc;
+			do
+				rc = OCIStmtFetch(
+					src.stmt_h,				// stmt handle
+					src.err_h,				// error handle
+					(ub4) batch_rows,			// #rows to fetch
+					(ub4) OCI_FETCH_NEXT,			// orientation
+					(ub4) OCI_DEFAULT);			// mode
+			while (rc == OCI_STILL_EXECUTING);
+			if (rc != OCI_SUCCESS && rc != OCI_SUCCESS_WITH_INFO && rc != OCI_NO_DATA)
+			{
+				OCI_Error e("Copy_Pipeline::read", src.err_h);
+				e.desc << "statement = {" << src.str() << "}";
+				throw e;
+			}
+
+			// the row count is cumulative
+			ub4 count;
+			if (OCIAttrGet(	(dvoid *) src.stmt_h,			// statement handle
+					(ub4) OCI_HTYPE_STMT,			// handle type
+					(dvoid *) &count,			// returned value
+					(ub4 *) 0,				// output size (0==default)
+					(ub4) OCI_ATTR_ROW_COUNT,		// attribute to return
+					src.err_h))				// error handle
+				throw OCI_Error("Copy_Pipeline::read", src.err_h);
+			int rows = count - prev;
+			prev = count;
+			nread += rows;
+
+			if (rows && xform)
+				rows = xform->transform(buf[k].cols, rows);
+
+			pthread_mutex_lock(&mtx);
+			buf[k].rows = rows;
+			buf[k].full = rows > 0;
+			if (rc == OCI_NO_DATA)
+				read_done = true;
+			pthread_cond_broadcast(&cv);
+			pthread_mutex_unlock(&mtx);
+			if (rc == OCI_NO_DATA)
+				break;
+			if (!rows)
+				k = 1 - k;					// reuse the same buffer
+		}
+	}
+	catch (Error& e)
+	{
+		pthread_mutex_lock(&mtx);
+		read_err = e.clone();
+		pthread_mutex_unlock(&mtx);
+	}
+	catch (...)
+	{
+		pthread_mutex_lock(&mtx);
+		read_err = new Error("Copy_Pipeline::read()", "Unexpected exception in fetch thread");
+		pthread_mutex_unlock(&mtx);
+	}
+
+	pthread_mutex_lock(&mtx);
+	read_done = true;
+	pthread_cond_broadcast(&cv);
+	pthread_mutex_unlock(&mtx);
+}
+
+
+long
+Oracle::Copy_Pipeline::run() throw(Oracle::Error)
+{
+	// the fetch thread makes OCI calls on src while this thread uses dst,
+	// so they need a threaded environment and their own Connections
+	if (!Env::threaded())
+		throw State_Error("Copy_Pipeline::run()", "The Oracle environment is not in threaded mode");
+	if (src.err_h == dst.err_h || src.db_ == &dst_db)
+	{
+		State_Error e("Copy_Pipeline::run()", "Source and destination share a Connection");
+		e.desc << "source = {" << src.str() << "}";
+		throw e;
+	}
+
+	double t0 = Env::now();
+	nread = nwritten = 0;
+	nbatches = 0;
+	t_fetch_wait = t_write_wait = 0;
+	read_done = stopping = false;
+	delete read_err;
+	read_err = 0;
+
+	free_buffers();
+	init_buffers();
+
+	pthread_t thr;
+	if (pthread_create(&thr, 0, thread_main, this))
+		throw Error("Copy_Pipeline::run()", "Cannot create fetch thread");
+
+	long since_commit = 0;
+	try
+	{
+		for (int k=0; ; k = 1 - k)
+		{
+			// wait for the fetcher to fill this buffer
+			double t = Env::now();
+			pthread_mutex_lock(&mtx);
+			while (!buf[k].full && !read_done)
+				pthread_cond_wait(&cv, &mtx);
+			bool full = buf[k].full;
+			int rows = buf[k].rows;
+			pthread_mutex_unlock(&mtx);
+			t_write_wait += Env::now() - t;
+
+			if (!full)
+				break;
+
+			bind(buf[k]);
+			dst.exec_batch(rows);
+			nwritten += rows;
+			nbatches++;
+			since_commit += rows;
+			if (commit_every && since_commit >= commit_every)
+			{
+				dst_db.commit();
+				since_commit = 0;
+			}
+
+			pthread_mutex_lock(&mtx);
+			buf[k].full = false;
+			pthread_cond_broadcast(&cv);
+			pthread_mutex_unlock(&mtx);
+		}
+	}
+	catch (...)
+	{
+		pthread_mutex_lock(&mtx);
+		stopping = true;
+		pthread_cond_broadcast(&cv);
+		pthread_mutex_unlock(&mtx);
+		pthread_join(thr, 0);
+		t_run = Env::now() - t0;
+		throw;
+	}
+
+	pthread_join(thr, 0);
+	t_run = Env::now() - t0;
+	if (read_err)
+		read_err->raise();					// keeps the ORA code of an OCI_Error
+	if (commit_every && since_commit)
+		dst_db.commit();
+	return nwritten;
+}
@@ -0,0 +1,132 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Ora++ -- a C++ interface to Oracle based on the Oracle Call Interface
+// Copyright (C) 2000-1 James Edwin Cain <me@jimcain.net>
+// 
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or any
+// later version.
+// 
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef ORAPP_COPY_PIPELINE_H
+#define ORAPP_COPY_PIPELINE_H
+
+#include "Oracle.h"
+#include <vector>
+#include <pthread.h>
+
+
+namespace Oracle
+{
+	class Connection;
+	class Select_Stmt;
+	class Non_Sel_Stmt;
+	class Nullable_Array;
+
+	// Changes a batch of rows in place between fetch and DML.  transform()
+	// is called in the fetching thread and returns the number of rows to
+	// write, which may be fewer than it was given if it compacts the arrays.
+	class Batch_Transform
+	{
+		public:
+			virtual ~Batch_Transform() {}
+			virtual int transform(						// change rows
+				std::vector<Nullable_Array*>&,				// one array per column
+				const int)				throw(Error) = 0; // rows in arrays
+	};
+
+
+	// Copies the rows of a query into a DML statement, typically an INSERT
+	// on another Connection whose placeholders match the select list by
+	// position.  One thread array-fetches into one set of arrays while the
+	// calling thread array-executes the other set, so fetch and DML overlap.
+	// With only two sets, a fetcher that gets ahead waits for the writer
+	// (and vice versa), which bounds memory use.
+	class Copy_Pipeline
+	{
+		public:
+			// constructors/destructor
+			Copy_Pipeline(
+				Select_Stmt&,						// source query
+				Non_Sel_Stmt&,						// target DML
+				Connection&)				throw(Error);	// target's Connection
+			virtual ~Copy_Pipeline()			throw();
+
+			// implementors
+			void set_batch_rows(const int)			throw(Error);	// rows per fetch/execute
+			void set_commit_every(const int)		throw(Error);	// commit target every n rows (0==never)
+			void set_transform(Batch_Transform*)		throw();	// optional, not owned
+			long run()					throw(Error);	// copy all rows, returns rows written
+
+			// accessors
+			long rows_read() const				throw()		// rows fetched
+				{ return nread; }
+			long rows_written() const			throw()		// rows executed
+				{ return nwritten; }
+			int batches() const				throw()		// array executes
+				{ return nbatches; }
+			double secs() const				throw()		// elapsed time of run()
+				{ return t_run; }
+			double fetch_wait_secs() const			throw()		// fetcher blocked on writer
+				{ return t_fetch_wait; }
+			double write_wait_secs() const			throw()		// writer blocked on fetcher
+				{ return t_write_wait; }
+			double rows_per_sec() const			throw()		// rows written / secs
+				{ return t_run > 0 ? nwritten / t_run : 0; }
+
+		protected:
+			// types
+			struct Buffer							// one set of column arrays
+			{
+				std::vector<Nullable_Array*> cols;
+				int rows;						// rows to write
+				bool full;						// filled, not yet written
+			};
+
+			// protected implementors
+			void init_buffers()				throw(Error);	// describe source, allocate arrays
+			void free_buffers()				throw();
+			void define(Buffer&)				throw(Error);	// fetch into buffer
+			void bind(Buffer&)				throw(Error);	// execute from buffer
+			void read()					throw();	// fetching thread body
+			static void* thread_main(void*);
+
+			// data members
+			Select_Stmt& src;
+			Non_Sel_Stmt& dst;
+			Connection& dst_db;
+			Batch_Transform* xform;
+			int batch_rows;
+			int commit_every;
+			Buffer buf[2];
+			bool read_done;							// no more batches will be filled
+			bool stopping;							// writer failed, fetcher should quit
+			Error* read_err;						// error raised by fetcher
+			pthread_mutex_t mtx;						// guards buf[].full/rows, flags
+			pthread_cond_t cv;						// a buffer changed state
+			long nread;
+			long nwritten;
+			int nbatches;
+			double t_run;
+			double t_fetch_wait;
+			double t_write_wait;
+
+		private:
+			// disallowed functions
+			Copy_Pipeline(const Copy_Pipeline&);
+			Copy_Pipeline& operator=(const Copy_Pipeline&);
+	};
+}
+
+#endif
@@ -34,41 +34,41 @@ const std::string Oracle::Date::default_fmt = "YYYY/MM/DD HH24:MI:SS";
 Oracle::Env Oracle::Date::env;
 
 Oracle::Date::Date() throw()
-	: Nullable(), date_(new OCIDate)
+	: Nullable(), date_(new OCIDate), ext(false)
 {
 }
 
 
 Oracle::Date::Date(OCIDate& d) throw(Oracle::Error)
-	: Nullable(), date_(new OCIDate)
+	: Nullable(), date_(new OCIDate), ext(false)
 {
 	if (OCIDateAssign(
-			env.err(),					// error handle
+			env.thread_err(),				// error handle
 			&d,						// from OCIDate
 			date_))						// to OCIDate
-		throw OCI_Error("Date::Date(OCIDate&)", env.err());
+		throw OCI_Error("Date::Date(OCIDate&)", env.thread_err());
 	ind = 0;
 }
 
 
 Oracle::Date::Date(const Oracle::Date& d) throw(Oracle::Error)
-	: Nullable(), date_(new OCIDate)
+	: Nullable(), date_(new OCIDate), ext(false)
 {
 	// if n is not null, initialize this Date with d's value
 	if ((ind = d.ind) == 0)
 		if (OCIDateAssign(
-				env.err(),				// error handle
+				env.thread_err(),			// error handle
 				d.date_,				// from OCIDate
 				date_))					// to OCIDate
-			throw OCI_Error("Date::Date(const Date&)", env.err());
+			throw OCI_Error("Date::Date(const Date&)", env.thread_err());
 }
 
 
 Oracle::Date::Date(const std::string& s) throw(Oracle::Error)
-	: Nullable(), date_(new OCIDate)
+	: Nullable(), date_(new OCIDate), ext(false)
 {
 	if (OCIDateFromText(
-			env.err(),					// error handle
+			env.thread_err(),				// error handle
 			(CONST text*) s.c_str(),			// input string
 			(ub4) s.length(),				// input string length
 			(CONST text*) default_fmt.c_str(),		// format string
@@ -77,7 +77,7 @@ Oracle::Date::Date(const std::string& s) throw(Oracle::Error)
 			(ub4) 0,					// language name length
 			date_))						// output buffer
 	{
-		OCI_Error e("Date::Date(const std::string&)", env.err());
+		OCI_Error e("Date::Date(const std::string&)", env.thread_err());
 		e.desc << "date string = {" << s << "}; default format = {" << default_fmt << "}";
 		throw e;
 	}
@@ -86,10 +86,10 @@ Oracle::Date::Date(const std::string& s) throw(Oracle::Error)
 
 
 Oracle::Date::Date(const std::string& s, const std::string& f) throw(Oracle::Error)
-	: Nullable(), date_(new OCIDate)
+	: Nullable(), date_(new OCIDate), ext(false)
 {
 	if (OCIDateFromText(
-			env.err(),					// error handle
+			env.thread_err(),				// error handle
 			(CONST text*) s.c_str(),			// input string
 			(ub4) s.length(),				// input string length
 			(CONST text*) f.c_str(),			// format string
@@ -98,7 +98,7 @@ Oracle::Date::Date(const std::string& s, const std::string& f) throw(Oracle::Err
 			(ub4) 0,					// language name length
 			date_))						// output buffer
 	{
-		OCI_Error e("Date::Date(const std::string&, const std::string&)", env.err());
+		OCI_Error e("Date::Date(const std::string&, const std::string&)", env.thread_err());
 		e.desc << "date string = {" << s << "}; format = {" << f << "}";
 		throw e;
 	}
@@ -106,9 +106,16 @@ Oracle::Date::Date(const std::string& s, const std::string& f) throw(Oracle::Err
 }
 
 
+Oracle::Date::Date(OCIDate* d) throw()
+	: Nullable(), date_(d), ext(true)
+{
+}
+
+
 Oracle::Date::~Date() throw()
 {
-	delete date_;
+	if (!ext)
+		delete date_;
 	ind = -1;
 }
 
@@ -131,7 +138,7 @@ Oracle::Date&
 Oracle::Date::assign(const std::string& s, const std::string& f) throw(Oracle::Error)
 {
 	if (OCIDateFromText(
-			env.err(),					// error handle
+			env.thread_err(),				// error handle
 			(CONST text*) s.c_str(),			// input string
 			(ub4) s.length(),				// input string length
 			(CONST text*) f.c_str(),			// format string
@@ -140,7 +147,7 @@ Oracle::Date::assign(const std::string& s, const std::string& f) throw(Oracle::E
 			(ub4) 0,					// language name length
 			date_))						// output buffer
 	{
-		OCI_Error e("Date::Date(const std::string&, const std::string&)", env.err());
+		OCI_Error e("Date::Date(const std::string&, const std::string&)", env.thread_err());
 		e.desc << "date string = {" << s << "}; format = {" << f << "}";
 		throw e;
 	}
@@ -157,7 +164,7 @@ Oracle::Date::str() const throw(Oracle::Error)
 	char buf[ORAPP_MAX_DATE_LEN];
 	ub4 buf_len(ORAPP_MAX_DATE_LEN);
 	if (OCIDateToText(
-			env.err(),					// error handle
+			env.thread_err(),				// error handle
 			date_,						// OCIDate to convert
 			(CONST text*) default_fmt.c_str(),		// format string
 			(ub1) default_fmt.length(),			// format string length
@@ -165,7 +172,7 @@ Oracle::Date::str() const throw(Oracle::Error)
 			(ub4) 0,					// language name length
 			(ub4*) &buf_len,				// output buffer size
 			(text*) buf))					// output buffer
-		throw OCI_Error("Date::str()", env.err());
+		throw OCI_Error("Date::str()", env.thread_err());
 	return buf;
 }
 
@@ -178,7 +185,7 @@ Oracle::Date::str(const std::string& s) const throw(Oracle::Error)
 	char buf[ORAPP_MAX_DATE_LEN];
 	ub4 buf_len(ORAPP_MAX_DATE_LEN);
 	if (OCIDateToText(
-			env.err(),					// error handle
+			env.thread_err(),				// error handle
 			date_,						// OCIDate to convert
 			(CONST text*) default_fmt.c_str(),		// format string
 			(ub1) default_fmt.length(),			// format string length
@@ -186,7 +193,7 @@ Oracle::Date::str(const std::string& s) const throw(Oracle::Error)
 			(ub4) 0,					// language name length
 			(ub4*) &buf_len,				// output buffer size
 			(text*) buf))					// output buffer
-		throw OCI_Error("Date::str(const std::string&)", env.err());
+		throw OCI_Error("Date::str(const std::string&)", env.thread_err());
 	return buf;
 }
 
@@ -199,7 +206,7 @@ Oracle::Date::str(const std::string& s, const std::string& f) const throw(Oracle
 	char buf[ORAPP_MAX_DATE_LEN];
 	ub4 buf_len(ORAPP_MAX_DATE_LEN);
 	if (OCIDateToText(
-			env.err(),					// error handle
+			env.thread_err(),				// error handle
 			date_,						// OCIDate to convert
 			(CONST text*) f.c_str(),			// format string
 			(ub1) f.length(),				// format string length
@@ -207,7 +214,7 @@ Oracle::Date::str(const std::string& s, const std::string& f) const throw(Oracle
 			(ub4) 0,					// language name length
 			(ub4*) &buf_len,				// output buffer size
 			(text*) buf))					// output buffer
-		throw OCI_Error("Date::str(const std::string&, const std::string&)", env.err());
+		throw OCI_Error("Date::str(const std::string&, const std::string&)", env.thread_err());
 	return buf;
 }
 
@@ -229,7 +236,7 @@ Oracle::Date::lng() const throw(Oracle::Error)
 	char buf[ORAPP_MAX_DATE_LEN];
 	ub4 buf_len(ORAPP_MAX_DATE_LEN);
 	if (OCIDateToText(
-			env.err(),					// error handle
+			env.thread_err(),				// error handle
 			date_,						// OCIDate to convert
 			(CONST text*) "J",				// format string
 			(ub1) 1,					// format string length
@@ -237,7 +244,7 @@ Oracle::Date::lng() const throw(Oracle::Error)
 			(ub4) 0,					// language name length
 			(ub4*) &buf_len,				// output buffer size
 			(text*) buf))					// output buffer
-		throw OCI_Error("Date::lng()", env.err());
+		throw OCI_Error("Date::lng()", env.thread_err());
 	char* p;
 	long l(std::strtol(buf, &p, 10));
 	if(p == buf)
@@ -255,7 +262,7 @@ Oracle::Date::lng(const long n) const throw(Oracle::Error)
 	char buf[ORAPP_MAX_DATE_LEN];
 	ub4 buf_len(ORAPP_MAX_DATE_LEN);
 	if (OCIDateToText(
-			env.err(),					// error handle
+			env.thread_err(),				// error handle
 			date_,						// OCIDate to convert
 			(CONST text*) "J",				// format string
 			(ub1) 1,					// format string length
@@ -263,7 +270,7 @@ Oracle::Date::lng(const long n) const throw(Oracle::Error)
 			(ub4) 0,					// language name length
 			(ub4*) &buf_len,				// output buffer size
 			(text*) buf))					// output buffer
-		throw OCI_Error("Date::lng(const long)", env.err());
+		throw OCI_Error("Date::lng(const long)", env.thread_err());
 	char* p;
 	long l(std::strtol(buf, &p, 10));
 	if(p == buf)
@@ -281,7 +288,7 @@ Oracle::Date::dbl() const throw(Oracle::Error)
 	char buf[ORAPP_MAX_DATE_LEN];
 	ub4 buf_len(ORAPP_MAX_DATE_LEN);
 	if (OCIDateToText(
-			env.err(),					// error handle
+			env.thread_err(),				// error handle
 			date_,						// OCIDate to convert
 			(CONST text*) "J",				// format string
 			(ub1) 1,					// format string length
@@ -289,7 +296,7 @@ Oracle::Date::dbl() const throw(Oracle::Error)
 			(ub4) 0,					// language name length
 			(ub4*) &buf_len,				// output buffer size
 			(text*) buf))					// output buffer
-		throw OCI_Error("Date::lng()", env.err());
+		throw OCI_Error("Date::lng()", env.thread_err());
 	char* p;
 	double d(std::strtod(buf, &p));
 	if(p == buf)
@@ -307,7 +314,7 @@ Oracle::Date::dbl(const double n) const throw(Oracle::Error)
 	char buf[ORAPP_MAX_DATE_LEN];
 	ub4 buf_len(ORAPP_MAX_DATE_LEN);
 	if (OCIDateToText(
-			env.err(),					// error handle
+			env.thread_err(),				// error handle
 			date_,						// OCIDate to convert
 			(CONST text*) "J",				// format string
 			(ub1) 1,					// format string length
@@ -315,7 +322,7 @@ Oracle::Date::dbl(const double n) const throw(Oracle::Error)
 			(ub4) 0,					// language name length
 			(ub4*) &buf_len,				// output buffer size
 			(text*) buf))					// output buffer
-		throw OCI_Error("Date::dbl(const double)", env.err());
+		throw OCI_Error("Date::dbl(const double)", env.thread_err());
 	char* p;
 	double d(std::strtod(buf, &p));
 	if(p == buf)
@@ -330,10 +337,10 @@ Oracle::Date::last_day() const throw(Oracle::Error)
 {
 	OCIDate last;
 	if (OCIDateLastDay(
-			env.err(),					// error handle
+			env.thread_err(),				// error handle
 			date_,						// input OCIDate
 			&last))						// output OCIDate
-		throw OCI_Error("Date::last_day()", env.err());
+		throw OCI_Error("Date::last_day()", env.thread_err());
 	return Date(last);
 }
 
@@ -343,13 +350,13 @@ Oracle::Date::next_day(const std::string& day) const throw(Oracle::Error)
 {
 	OCIDate next;
 	if (OCIDateNextDay(
-			env.err(),					// error handle
+			env.thread_err(),				// error handle
 			date_,						// input OCIDate
 			(text*) day.c_str(),				// day of week
 			(ub4) day.length(),				// day of week length
 			&next))						// output OCIDate
 	{
-		OCI_Error e("Date::next_day(const std::string&)", env.err());
+		OCI_Error e("Date::next_day(const std::string&)", env.thread_err());
 		e.desc << "date = {" << str() << "}; day = {" << day << "}";
 		throw e;
 	}
@@ -365,10 +372,10 @@ Oracle::Date::operator=(const Oracle::Date& rhs) throw(Oracle::Error)
 		ind = rhs.ind;
 		if (ind == 0)
 			if (OCIDateAssign(
-					env.err(),			// error handle
+					env.thread_err(),		// error handle
 					rhs.date_,			// from OCIDate
 					date_))				// to OCIDate
-				throw OCI_Error("Date::operator=(const Date&)", env.err());
+				throw OCI_Error("Date::operator=(const Date&)", env.thread_err());
 	}
 	return *this;
 }
@@ -378,7 +385,7 @@ Oracle::Date&
 Oracle::Date::operator=(const char* rhs) throw(Oracle::Error)
 {
 	if (OCIDateFromText(
-			env.err(),					// error handle
+			env.thread_err(),				// error handle
 			(CONST text*) rhs,				// input string
 			(ub4) std::strlen(rhs),				// input string length
 			(CONST text*) default_fmt.c_str(),		// format string
@@ -387,7 +394,7 @@ Oracle::Date::operator=(const char* rhs) throw(Oracle::Error)
 			(ub4) 0,					// language name length
 			date_))						// output buffer
 	{
-		OCI_Error e("Date::operator=(const char*)", env.err());
+		OCI_Error e("Date::operator=(const char*)", env.thread_err());
 		e.desc << "date string = {" << rhs << "}; default format = {" << default_fmt << "}";
 		throw e;
 	}
@@ -400,7 +407,7 @@ Oracle::Date&
 Oracle::Date::operator=(const std::string& rhs) throw(Oracle::Error)
 {
 	if (OCIDateFromText(
-			env.err(),					// error handle
+			env.thread_err(),				// error handle
 			(CONST text*) rhs.c_str(),			// input string
 			(ub4) rhs.length(),				// input string length
 			(CONST text*) default_fmt.c_str(),		// format string
@@ -409,7 +416,7 @@ Oracle::Date::operator=(const std::string& rhs) throw(Oracle::Error)
 			(ub4) 0,					// language name length
 			date_))						// output buffer
 	{
-		OCI_Error e("Date::operator=(const std::string&)", env.err());
+		OCI_Error e("Date::operator=(const std::string&)", env.thread_err());
 		e.desc << "date string = {" << rhs << "}; default format = {" << default_fmt << "}";
 		throw e;
 	}
@@ -422,11 +429,11 @@ Oracle::Date&
 Oracle::Date::operator+=(const Oracle::Days& days) throw(Oracle::Error)
 {
 	if (OCIDateAddDays(
-			env.err(),					// error handle
+			env.thread_err(),				// error handle
 			date_,						// input OCIDate
 			(sb4) days.days_,				// number of days
 			date_))						// output OCIDate
-		throw OCI_Error("Oracle::operator+=(const Days&)", env.err());
+		throw OCI_Error("Oracle::operator+=(const Days&)", env.thread_err());
 	return *this;
 }
 
@@ -435,11 +442,11 @@ Oracle::Date&
 Oracle::Date::operator+=(const Oracle::Months& months) throw(Oracle::Error)
 {
 	if (OCIDateAddMonths(
-			env.err(),					// error handle
+			env.thread_err(),				// error handle
 			date_,						// input OCIDate
 			(sb4) months.months_,				// number of days
 			date_))						// output OCIDate
-		throw OCI_Error("Oracle::operator+=(const Months&)", env.err());
+		throw OCI_Error("Oracle::operator+=(const Months&)", env.thread_err());
 	return *this;
 }
 
@@ -448,11 +455,11 @@ Oracle::Date&
 Oracle::Date::operator-=(const Oracle::Days& days) throw(Oracle::Error)
 {
 	if (OCIDateAddDays(
-			env.err(),					// error handle
+			env.thread_err(),				// error handle
 			date_,						// input OCIDate
 			(sb4) -days.days_,				// number of days
 			date_))						// output OCIDate
-		throw OCI_Error("Oracle::operator+=(const Days&)", env.err());
+		throw OCI_Error("Oracle::operator+=(const Days&)", env.thread_err());
 	return *this;
 }
 
@@ -461,11 +468,11 @@ Oracle::Date&
 Oracle::Date::operator-=(const Oracle::Months& months) throw(Oracle::Error)
 {
 	if (OCIDateAddMonths(
-			env.err(),					// error handle
+			env.thread_err(),				// error handle
 			date_,						// input OCIDate
 			(sb4) -months.months_,				// number of days
 			date_))						// output OCIDate
-		throw OCI_Error("Oracle::operator+=(const Months&)", env.err());
+		throw OCI_Error("Oracle::operator+=(const Months&)", env.thread_err());
 	return *this;
 }
 
@@ -475,11 +482,11 @@ Oracle::Date::operator-(const Oracle::Date& d) throw(Oracle::Error)
 {
 	sb4 diff;
 	if (OCIDateDaysBetween(
-			env.err(),					// error handle
+			env.thread_err(),				// error handle
 			date_,						// first date
 			d.date_,					// second date
 			&diff))						// difference
-		throw OCI_Error("Date::operator-(const Date&)", env.err());
+		throw OCI_Error("Date::operator-(const Date&)", env.thread_err());
 	return diff;
 }
 
@@ -495,11 +502,11 @@ Oracle::Date::operator==(const Oracle::Date& d) throw(Oracle::Error)
 	{
 		sword result;
 		if (OCIDateCompare(
-				env.err(),				// error handle
+				env.thread_err(),			// error handle
 				date_,					// first date
 				d.date_,				// second date
 				&result))				// -1, 0 or 1
-			throw OCI_Error("Date::operator==(const Date&)", env.err());
+			throw OCI_Error("Date::operator==(const Date&)", env.thread_err());
 		return result == 0;
 	}
 }
@@ -516,11 +523,11 @@ Oracle::Date::operator!=(const Oracle::Date& d) throw(Oracle::Error)
 	{
 		sword result;
 		if (OCIDateCompare(
-				env.err(),				// error handle
+				env.thread_err(),			// error handle
 				date_,					// first date
 				d.date_,				// second date
 				&result))				// -1, 0 or 1
-			throw OCI_Error("Date::operator==(const Date&)", env.err());
+			throw OCI_Error("Date::operator==(const Date&)", env.thread_err());
 		return result != 0;
 	}
 }
@@ -537,11 +544,11 @@ Oracle::Date::operator<(const Oracle::Date& d) throw(Oracle::Error)
 	{
 		sword result;
 		if (OCIDateCompare(
-				env.err(),				// error handle
+				env.thread_err(),			// error handle
 				date_,					// first date
 				d.date_,				// second date
 				&result))				// -1, 0 or 1
-			throw OCI_Error("Date::operator==(const Date&)", env.err());
+			throw OCI_Error("Date::operator==(const Date&)", env.thread_err());
 		return result == -1;
 	}
 }
@@ -558,11 +565,11 @@ Oracle::Date::operator<=(const Oracle::Date& d) throw(Oracle::Error)
 	{
 		sword result;
 		if (OCIDateCompare(
-				env.err(),				// error handle
+				env.thread_err(),			// error handle
 				date_,					// first date
 				d.date_,				// second date
 				&result))				// -1, 0 or 1
-			throw OCI_Error("Date::operator==(const Date&)", env.err());
+			throw OCI_Error("Date::operator==(const Date&)", env.thread_err());
 		return result != 1;
 	}
 }
@@ -579,11 +586,11 @@ Oracle::Date::operator>(const Oracle::Date& d) throw(Oracle::Error)
 	{
 		sword result;
 		if (OCIDateCompare(
-				env.err(),				// error handle
+				env.thread_err(),			// error handle
 				date_,					// first date
 				d.date_,				// second date
 				&result))				// -1, 0 or 1
-			throw OCI_Error("Date::operator==(const Date&)", env.err());
+			throw OCI_Error("Date::operator==(const Date&)", env.thread_err());
 		return result == 1;
 	}
 }
@@ -600,11 +607,11 @@ Oracle::Date::operator>=(const Oracle::Date& d) throw(Oracle::Error)
 	{
 		sword result;
 		if (OCIDateCompare(
-				env.err(),				// error handle
+				env.thread_err(),			// error handle
 				date_,					// first date
 				d.date_,				// second date
 				&result))				// -1, 0 or 1
-			throw OCI_Error("Date::operator==(const Date&)", env.err());
+			throw OCI_Error("Date::operator==(const Date&)", env.thread_err());
 		return result != -1;
 	}
 }
@@ -615,9 +622,9 @@ Oracle::Date::sysdate() throw(Oracle::Error)
 {
 	OCIDate now;
 	if (OCIDateSysDate(
-			Date::env.err(),			// error handle
+			Date::env.thread_err(),			// error handle
 			&now))					// output OCIDate
-		throw OCI_Error("Date::Date(const init_date_t)", Date::env.err());
+		throw OCI_Error("Date::Date(const init_date_t)", Date::env.thread_err());
 	return Date(now);
 }
 
@@ -97,16 +97,22 @@ namespace Oracle
 			static Date sysdate()				throw(Error);	// date/time on client
 			
 		protected:
-			// constructor
+			// constructors
 			Date(OCIDate&)					throw(Error);	// internal constructor
+			Date(OCIDate*)					throw();	// use given storage
 
 			// implementors
 			virtual void* data() const throw() { return (void*)date_; };	// ptr to data
 			
 			// data members
 			OCIDate* date_;
+			bool ext;							// date_ is not owned
 			static const std::string default_fmt;
 			static Env env;
+
+		friend class Column_Batch;
+		friend class Rowtype;
+		friend class Date_Array;
 	};
 
 	inline std::ostream& operator<<(std::ostream& o, const Date& d)
@@ -0,0 +1,457 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Ora++ -- a C++ interface to Oracle based on the Oracle Call Interface
+// Copyright (C) 2000-1 James Edwin Cain <me@jimcain.net>
+// 
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or any
+// later version.
+// 
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Oracle.h"
+#include "Direct_Load.h"
+#include "Connection.h"
+#include "Rowtype.h"
+#include "Nullable.h"
+#include "Nullable_Array.h"
+#include "Date.h"
+#include "Env.h"
+#include <oci.h>
+#include <cstring>
+
+
+namespace
+{
+	// default maximum characters per column
+	const int default_width = 255;
+}
+
+
+Oracle::Direct_Load::Direct_Load(Connection& conn, const std::string& tab, const std::vector<std::string>& c) throw(Oracle::Error)
+	: db(conn), cols(c), width(c.size(), default_width), buf(c.size(), (char*) 0), buf_sz(0),
+	  st(Initialized), err_h(0), ctx_h(0), ca_h(0), strm_h(0), arr_rows(0), row(0),
+	  rows_sent(0), loads(0), t0(0), t1(0)
+{
+	if (cols.empty())
+		throw Value_Error("Direct_Load::Direct_Load", "At least one column is required");
+
+	int dot = tab.find('.');
+	if (dot == std::string::npos)
+		table = tab;
+	else
+	{
+		schema = tab.substr(0, dot);
+		table = tab.substr(dot + 1);
+	}
+}
+
+
+Oracle::Direct_Load::~Direct_Load() throw()
+{
+	if (st == Prepared)
+		abort();
+	free_handles();
+}
+
+
+void
+Oracle::Direct_Load::set_buffer_size(const int n) throw(Oracle::Error)
+{
+	if (st != Initialized)
+		throw State_Error("Direct_Load::set_buffer_size(const int)", "Load has already been prepared");
+	buf_sz = n;
+}
+
+
+void
+Oracle::Direct_Load::set_width(const int c, const int w) throw(Oracle::Error)
+{
+	if (st != Initialized)
+		throw State_Error("Direct_Load::set_width(const int, const int)", "Load has already been prepared");
+	if (c < 0 || c >= cols.size() || w < 1)
+	{
+		Value_Error e("Direct_Load::set_width(const int, const int)", "Column or width out of range");
+		e.desc << "column = " << c << "; width = " << w;
+		throw e;
+	}
+	width[c] = w;
+}
+
+
+void
+Oracle::Direct_Load::prepare() throw(Oracle::Error)
+{
+	if (st != Initialized)
+		throw State_Error("Direct_Load::prepare()", "Load has already been prepared");
+
+	// connect to database if necessary
+	if (db.stat == Connection::not_connected)
+		db.open();
+	err_h = db.err_handle();
+
+	// the direct path calls do not support OCI_STILL_EXECUTING
+	if (db.nonblocking())
+		throw State_Error("Direct_Load::prepare()", "Connection is in non-blocking mode");
+
+	// allocate the direct path context
+	if (OCIHandleAlloc(
+			(dvoid *) db.env_handle(),				// env handle
+			(dvoid **) &ctx_h,					// context returned
+			(ub4) OCI_HTYPE_DIRPATH_CTX,				// handle type
+			(size_t) 0,						// user-def memory size
+			(dvoid **) 0))						// user-def memory ptr
+		throw Error("Direct_Load::prepare()", "OCIHandleAlloc failed for direct path context");
+
+	try
+	{
+		// describe the target table and how data will be supplied
+		ub2 ncols = cols.size();
+		ub4 n = buf_sz;
+		std::string fmt("YYYY/MM/DD HH24:MI:SS");		// Date::str() format
+		if (OCIAttrSet((dvoid *) ctx_h, (ub4) OCI_HTYPE_DIRPATH_CTX,
+				(dvoid *) table.c_str(), (ub4) table.length(), (ub4) OCI_ATTR_NAME, err_h)
+			|| (schema.length() && OCIAttrSet((dvoid *) ctx_h, (ub4) OCI_HTYPE_DIRPATH_CTX,
+				(dvoid *) schema.c_str(), (ub4) schema.length(), (ub4) OCI_ATTR_SCHEMA_NAME, err_h))
+			|| (buf_sz && OCIAttrSet((dvoid *) ctx_h, (ub4) OCI_HTYPE_DIRPATH_CTX,
+				(dvoid *) &n, (ub4) 0, (ub4) OCI_ATTR_BUF_SIZE, err_h))
+			|| OCIAttrSet((dvoid *) ctx_h, (ub4) OCI_HTYPE_DIRPATH_CTX,
+				(dvoid *) fmt.c_str(), (ub4) fmt.length(), (ub4) OCI_ATTR_DATEFORMAT, err_h)
+			|| OCIAttrSet((dvoid *) ctx_h, (ub4) OCI_HTYPE_DIRPATH_CTX,
+				(dvoid *) &ncols, (ub4) 0, (ub4) OCI_ATTR_NUM_COLS, err_h))
+		{
+			OCI_Error e("Direct_Load::prepare()", err_h);
+			e.desc << "table = {" << table << "}";
+			throw e;
+		}
+
+		// every column is supplied as character data
+		OCIParam* list_h;
+		if (OCIAttrGet(	(dvoid *) ctx_h,				// context
+				(ub4) OCI_HTYPE_DIRPATH_CTX,			// handle type
+				(dvoid *) &list_h,				// column list returned
+				(ub4 *) 0,					// size (0==default)
+				(ub4) OCI_ATTR_LIST_COLUMNS,			// attribute to return
+				err_h))						// error handle
+			throw OCI_Error("Direct_Load::prepare()", err_h);
+
+		for (int i=0; i < cols.size(); i++)
+		{
+			OCIParam* col_h = 0;
+			ub2 type = SQLT_CHR;
+			ub4 size = width[i];
+			if (OCIParamGet((dvoid *) list_h, (ub4) OCI_DTYPE_PARAM, err_h, (dvoid **) &col_h, (ub4) i + 1)
+				|| OCIAttrSet((dvoid *) col_h, (ub4) OCI_DTYPE_PARAM,
+					(dvoid *) cols[i].c_str(), (ub4) cols[i].length(), (ub4) OCI_ATTR_NAME, err_h)
+				|| OCIAttrSet((dvoid *) col_h, (ub4) OCI_DTYPE_PARAM,
+					(dvoid *) &type, (ub4) 0, (ub4) OCI_ATTR_DATA_TYPE, err_h)
+				|| OCIAttrSet((dvoid *) col_h, (ub4) OCI_DTYPE_PARAM,
+					(dvoid *) &size, (ub4) 0, (ub4) OCI_ATTR_DATA_SIZE, err_h))
+			{
+				OCI_Error e("Direct_Load::prepare()", err_h);
+				e.desc << "column = {" << cols[i] << "}";
+				throw e;
+			}
+			OCIDescriptorFree((dvoid *) col_h, (ub4) OCI_DTYPE_PARAM);
+		}
+
+		// start the load
+		if (OCIDirPathPrepare(ctx_h, db.svc_handle(), err_h))
+		{
+			OCI_Error e("Direct_Load::prepare()", err_h);
+			e.desc << "table = {" << table << "}";
+			throw e;
+		}
+
+		// allocate the column array and stream
+		if (OCIHandleAlloc((dvoid *) ctx_h, (dvoid **) &ca_h,
+					(ub4) OCI_HTYPE_DIRPATH_COLUMN_ARRAY, (size_t) 0, (dvoid **) 0)
+				|| OCIHandleAlloc((dvoid *) ctx_h, (dvoid **) &strm_h,
+					(ub4) OCI_HTYPE_DIRPATH_STREAM, (size_t) 0, (dvoid **) 0))
+			throw Error("Direct_Load::prepare()", "OCIHandleAlloc failed for direct path array");
+
+		ub4 nrows;
+		if (OCIAttrGet(	(dvoid *) ca_h,					// column array
+				(ub4) OCI_HTYPE_DIRPATH_COLUMN_ARRAY,		// handle type
+				(dvoid *) &nrows,				// rows returned
+				(ub4 *) 0,					// size (0==default)
+				(ub4) OCI_ATTR_NUM_ROWS,			// attribute to return
+				err_h))						// error handle
+			throw OCI_Error("Direct_Load::prepare()", err_h);
+		arr_rows = nrows;
+	}
+	catch (Error&)
+	{
+		if (ca_h)
+			OCIDirPathAbort(ctx_h, err_h);
+		free_handles();
+		throw;
+	}
+
+	for (int i=0; i < cols.size(); i++)
+		buf[i] = new char[arr_rows * width[i]];
+
+	st = Prepared;
+	row = 0;
+	rows_sent = loads = 0;
+	t0 = Env::now();
+	t1 = 0;
+}
+
+
+void
+Oracle::Direct_Load::check_prepared(const std::string& module) throw(Oracle::Error)
+{
+	if (st == Initialized)
+		prepare();
+	else if (st == Finished)
+		throw State_Error(module, "Load has finished");
+	else if (db.nonblocking())
+		throw State_Error(module, "Connection is in non-blocking mode");
+}
+
+
+void
+Oracle::Direct_Load::set_entry(const int c, const char* p, const int n, const bool null) throw(Oracle::Error)
+{
+	if (n > width[c])
+	{
+		Value_Error e("Direct_Load::set_entry", "Value is too long");
+		e.desc << "column = {" << cols[c] << "}; length = " << n << "; width = " << width[c];
+		throw e;
+	}
+
+	// the column array only points at the data, so it is always staged
+	// in buf until the array is loaded
+	if (OCIDirPathColArrayEntrySet(
+			ca_h,							// column array
+			err_h,							// error handle
+			(ub4) row,						// row offset
+			(ub2) c,						// column index
+			(ub1 *) p,						// data
+			(ub4) n,						// data length
+			(ub1) (null ? OCI_DIRPATH_COL_NULL : OCI_DIRPATH_COL_COMPLETE)))
+	{
+		OCI_Error e("Direct_Load::set_entry", err_h);
+		e.desc << "column = {" << cols[c] << "}";
+		throw e;
+	}
+}
+
+
+void
+Oracle::Direct_Load::end_row() throw(Oracle::Error)
+{
+	if (++row == arr_rows)
+		load_array();
+}
+
+
+void
+Oracle::Direct_Load::add_row(const Rowtype& r) throw(Oracle::Error)
+{
+	check_prepared("Direct_Load::add_row(const Rowtype&)");
+	if (r.ncols() != cols.size())
+	{
+		Value_Error e("Direct_Load::add_row(const Rowtype&)", "Wrong number of columns");
+		e.desc << "columns = " << r.ncols() << "; expected = " << cols.size();
+		throw e;
+	}
+
+	for (int c=0; c < cols.size(); c++)
+	{
+		if (r[c].is_null())
+		{
+			set_entry(c, 0, 0, true);
+			continue;
+		}
+		std::string s = r[c].str();
+		char* p = buf[c] + row * width[c];
+		int n = s.length() < width[c] ? s.length() : width[c];
+		s.copy(p, n);
+		set_entry(c, p, s.length(), false);
+	}
+	end_row();
+}
+
+
+void
+Oracle::Direct_Load::add_rows(const std::vector<Nullable_Array*>& a, const int n) throw(Oracle::Error)
+{
+	check_prepared("Direct_Load::add_rows(const std::vector<Nullable_Array*>&, const int)");
+	if (a.size() != cols.size())
+	{
+		Value_Error e("Direct_Load::add_rows(const std::vector<Nullable_Array*>&, const int)",
+			"Wrong number of columns");
+		e.desc << "columns = " << a.size() << "; expected = " << cols.size();
+		throw e;
+	}
+	for (int c=0; c < a.size(); c++)
+		if (n > a[c]->size())
+		{
+			Value_Error e("Direct_Load::add_rows(const std::vector<Nullable_Array*>&, const int)",
+				"Row count exceeds array size");
+			e.desc << "rows = " << n << "; column = {" << cols[c] << "}; size = " << a[c]->size();
+			throw e;
+		}
+
+	for (int i=0; i < n; i++)
+	{
+		for (int c=0; c < a.size(); c++)
+		{
+			if (a[c]->is_null(i))
+			{
+				set_entry(c, 0, 0, true);
+				continue;
+			}
+
+			// strings are copied straight from the array, since the
+			// caller may reuse it before the column array is loaded
+			char* p = buf[c] + row * width[c];
+			Varchar_Array* va = dynamic_cast<Varchar_Array*>(a[c]);
+			if (va)
+			{
+				Str_View v = va->view(i);
+				std::memcpy(p, v.data(), v.size() < width[c] ? v.size() : width[c]);
+				set_entry(c, p, v.size(), false);
+				continue;
+			}
+
+			std::string s = a[c]->str(i);
+			int len = s.length() < width[c] ? s.length() : width[c];
+			s.copy(p, len);
+			set_entry(c, p, s.length(), false);
+		}
+		end_row();
+	}
+}
+
+
+void
+Oracle::Direct_Load::load_array() throw(Oracle::Error)
+{
+	if (!row)
+		return;
+
+	// A stream may fill before the whole column array is converted, in
+	// which case it is loaded and conversion continues where it stopped.
+	ub4 off = 0;
+	for (;;)
+	{
+		sword rc = OCIDirPathColArrayToStream(
+				ca_h,						// column array
+				ctx_h,						// context
+				strm_h,						// stream
+				err_h,						// error handle
+				(ub4) row,					// rows in array
+				off);						// first row to convert
+		if (rc != OCI_SUCCESS && rc != OCI_CONTINUE)
+		{
+			OCI_Error e("Direct_Load::load_array()", err_h);
+			e.desc << "table = {" << table << "}; row = " << rows_sent + off;
+			throw e;
+		}
+
+		if (OCIDirPathLoadStream(ctx_h, strm_h, err_h))
+		{
+			OCI_Error e("Direct_Load::load_array()", err_h);
+			e.desc << "table = {" << table << "}";
+			throw e;
+		}
+		loads++;
+		OCIDirPathStreamReset(strm_h, err_h);
+		if (rc == OCI_SUCCESS)
+			break;
+
+		ub4 done;
+		if (OCIAttrGet(	(dvoid *) ca_h,					// column array
+				(ub4) OCI_HTYPE_DIRPATH_COLUMN_ARRAY,		// handle type
+				(dvoid *) &done,				// rows converted
+				(ub4 *) 0,					// size (0==default)
+				(ub4) OCI_ATTR_ROW_COUNT,			// attribute to return
+				err_h))						// error handle
+			throw OCI_Error("Direct_Load::load_array()", err_h);
+		off += done;
+	}
+
+	OCIDirPathColArrayReset(ca_h, err_h);
+	rows_sent += row;
+	row = 0;
+}
+
+
+void
+Oracle::Direct_Load::finish() throw(Oracle::Error)
+{
+	check_prepared("Direct_Load::finish()");
+	load_array();
+	if (OCIDirPathFinish(ctx_h, err_h))
+	{
+		OCI_Error e("Direct_Load::finish()", err_h);
+		e.desc << "table = {" << table << "}";
+		throw e;
+	}
+	t1 = Env::now();
+	st = Finished;
+	free_handles();
+}
+
+
+void
+Oracle::Direct_Load::abort() throw()
+{
+	if (st == Prepared)
+		OCIDirPathAbort(ctx_h, err_h);
+	if (!t1)
+		t1 = Env::now();
+	st = Finished;
+	free_handles();
+}
+
+
+void
+Oracle::Direct_Load::free_handles() throw()
+{
+	if (strm_h)
+		OCIHandleFree((dvoid *) strm_h, (ub4) OCI_HTYPE_DIRPATH_STREAM);
+	if (ca_h)
+		OCIHandleFree((dvoid *) ca_h, (ub4) OCI_HTYPE_DIRPATH_COLUMN_ARRAY);
+	if (ctx_h)
+		OCIHandleFree((dvoid *) ctx_h, (ub4) OCI_HTYPE_DIRPATH_CTX);
+	strm_h = 0;
+	ca_h = 0;
+	ctx_h = 0;
+
+	for (int i=0; i < buf.size(); i++)
+	{
+		delete [] buf[i];
+		buf[i] = 0;
+	}
+}
+
+
+double
+Oracle::Direct_Load::secs() const throw()
+{
+	if (!t0)
+		return 0;
+	return (t1 ? t1 : Env::now()) - t0;
+}
+
+
+double
+Oracle::Direct_Load::rows_per_sec() const throw()
+{
+	double t = secs();
+	return t > 0 ? rows_sent / t : 0;
+}
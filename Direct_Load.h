@@ -0,0 +1,115 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Ora++ -- a C++ interface to Oracle based on the Oracle Call Interface
+// Copyright (C) 2000-1 James Edwin Cain <me@jimcain.net>
+// 
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or any
+// later version.
+// 
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef ORAPP_DIRECT_LOAD_H
+#define ORAPP_DIRECT_LOAD_H
+
+#include "Oracle.h"
+#include <vector>
+
+class OCIDirPathCtx;
+class OCIDirPathColArray;
+class OCIDirPathStream;
+class OCIError;
+
+
+namespace Oracle
+{
+	class Connection;
+	class Rowtype;
+	class Nullable_Array;
+
+	// Loads rows into a table with the OCI direct path API, which formats
+	// data blocks on the client and writes them above the high water mark,
+	// bypassing SQL.  Rows are staged in a column array as character data
+	// (dates in Date's default format), converted to a stream and sent
+	// whenever the array is full.  The rows are saved by finish(); if the
+	// object is destroyed first, the load is aborted.
+	class Direct_Load
+	{
+		public:
+			// constructors/destructor
+			Direct_Load(
+				Connection&,						// use this Connection
+				const std::string&,					// table, optionally SCHEMA.TABLE
+				const std::vector<std::string>&) throw(Error);	// columns, in row order
+			virtual ~Direct_Load()				throw();
+
+			// implementors
+			void set_buffer_size(const int)			throw(Error);	// stream buffer bytes (0==OCI default)
+			void set_width(const int, const int)		throw(Error);	// max characters for a column
+			void prepare()					throw(Error);	// start the load
+			void add_row(const Rowtype&)			throw(Error);	// one row, columns in order
+			void add_rows(							// rows from typed arrays
+				const std::vector<Nullable_Array*>&,			// one array per column
+				const int)				throw(Error);	// number of rows
+			void finish()					throw(Error);	// send remaining rows and save
+			void abort()					throw();	// discard the load
+
+			// accessors
+			long nrows() const				throw()		// rows sent to the server
+				{ return rows_sent; }
+			int nloads() const				throw()		// streams sent
+				{ return loads; }
+			int array_rows() const				throw()		// rows per column array
+				{ return arr_rows; }
+			double secs() const				throw();	// elapsed time since prepare()
+			double rows_per_sec() const			throw();	// load throughput
+
+		protected:
+			// types
+			enum state_t { Initialized, Prepared, Finished };
+
+			// protected implementors
+			void set_entry(const int, const char*, const int, const bool) throw(Error); // stage one value
+			void end_row()					throw(Error);	// load array when full
+			void load_array()				throw(Error);	// convert and send column array
+			void free_handles()				throw();
+			void check_prepared(const std::string&)		throw(Error);
+
+			// data members
+			Connection& db;
+			std::string schema;
+			std::string table;
+			std::vector<std::string> cols;
+			std::vector<int> width;						// max characters per column
+			std::vector<char*> buf;						// staging text, one per column
+			int buf_sz;							// stream buffer size
+			state_t st;
+			OCIError* err_h;						// error handle
+			OCIDirPathCtx* ctx_h;						// direct path context
+			OCIDirPathColArray* ca_h;					// column array
+			OCIDirPathStream* strm_h;					// stream
+			int arr_rows;							// rows per column array
+			int row;							// rows staged in column array
+			long rows_sent;							// rows loaded
+			int loads;							// streams loaded
+			double t0;							// prepare() time
+			double t1;							// finish() time
+
+		private:
+			// disallowed functions
+			Direct_Load(const Direct_Load&);
+			Direct_Load& operator=(const Direct_Load&);
+	};
+}
+
+#endif
@@ -22,45 +22,214 @@
 #include "Oracle.h"
 #include "Env.h"
 #include <oci.h>
+#include <cstdlib>
+#include <sys/time.h>
 
 
+pthread_once_t Oracle::Env::once = PTHREAD_ONCE_INIT;
+
+pthread_key_t Oracle::Env::err_key;
+
 bool Oracle::Env::inited = false;
 
+bool Oracle::Env::thr = true;
+
 OCIEnv* Oracle::Env::env_h = 0;
 
 OCIError* Oracle::Env::err_h = 0;
 
+Oracle::Env::alloc_fn Oracle::Env::user_alloc = 0;
+
+Oracle::Env::realloc_fn Oracle::Env::user_realloc = 0;
+
+Oracle::Env::free_fn Oracle::Env::user_free = 0;
+
+void* Oracle::Env::user_ctx = 0;
+
+bool Oracle::Env::counting = false;
+
+long Oracle::Env::n_alloc = 0;
+
+long Oracle::Env::n_realloc = 0;
+
+long Oracle::Env::n_free = 0;
+
+long Oracle::Env::n_bytes = 0;
+
+long Oracle::Env::n_in_use = 0;
+
+
+namespace
+{
+	// Counted blocks carry their size in a header, so frees can be
+	// subtracted from the bytes in use.  The header keeps the block
+	// aligned as strictly as malloc's.
+	const size_t hdr_size = 16;
+}
+
+
+void
+Oracle::Env::set_threaded(const bool on) throw(Oracle::Error)
+{
+	if (inited)
+		throw State_Error("Env::set_threaded", "Oracle environment is already initialized");
+	thr = on;
+}
+
+
+void
+Oracle::Env::set_allocator(alloc_fn a, realloc_fn r, free_fn f, void* ctx) throw(Oracle::Error)
+{
+	if (inited)
+		throw State_Error("Env::set_allocator", "Oracle environment is already initialized");
+	if ((a || r || f) && !(a && r && f))
+		throw Value_Error("Env::set_allocator", "All three callbacks must be given, or none");
+	user_alloc = a;
+	user_realloc = r;
+	user_free = f;
+	user_ctx = ctx;
+}
+
+
+void
+Oracle::Env::set_counting(const bool on) throw(Oracle::Error)
+{
+	if (inited)
+		throw State_Error("Env::set_counting", "Oracle environment is already initialized");
+	counting = on;
+}
+
+
+void*
+Oracle::Env::count_alloc(void*, size_t n)
+{
+	char* p = (char*) (user_alloc ? user_alloc(user_ctx, n + hdr_size) : std::malloc(n + hdr_size));
+	if (!p)
+		return 0;
+	*(size_t*) p = n;
+	__sync_fetch_and_add(&n_alloc, 1);
+	__sync_fetch_and_add(&n_bytes, (long) n);
+	__sync_fetch_and_add(&n_in_use, (long) n);
+	return p + hdr_size;
+}
+
+
+void*
+Oracle::Env::count_realloc(void* ctx, void* mem, size_t n)
+{
+	if (!mem)
+		return count_alloc(ctx, n);
+
+	char* old = (char*) mem - hdr_size;
+	size_t old_n = *(size_t*) old;
+	char* p = (char*) (user_realloc ? user_realloc(user_ctx, old, n + hdr_size) : std::realloc(old, n + hdr_size));
+	if (!p)
+		return 0;
+	*(size_t*) p = n;
+	__sync_fetch_and_add(&n_realloc, 1);
+	if (n > old_n)
+		__sync_fetch_and_add(&n_bytes, (long) (n - old_n));
+	__sync_fetch_and_add(&n_in_use, (long) n - (long) old_n);
+	return p + hdr_size;
+}
+
+
+void
+Oracle::Env::count_free(void*, void* mem)
+{
+	if (!mem)
+		return;
+
+	char* p = (char*) mem - hdr_size;
+	__sync_fetch_and_add(&n_free, 1);
+	__sync_fetch_and_sub(&n_in_use, (long) *(size_t*) p);
+	if (user_free)
+		user_free(user_ctx, p);
+	else
+		std::free(p);
+}
+
 
-Oracle::Env::Env() throw(Oracle::Error)
+void
+Oracle::Env::init() throw(Oracle::Error)
 {
+	// Any class which calls OCI functions gets its handles through env()
+	// or err(), so the first call from any thread initializes the process.
+	pthread_once(&once, do_init);
 	if (!inited)
+		throw Error("Env::init", "Could not initialize Oracle environment", __FILE__, __LINE__);
+}
+
+
+void
+Oracle::Env::do_init() throw()
+{
+	// Threaded mode lets separate Connections be used from separate threads.
+	// OCI memory goes through the installed callbacks, wrapped in the
+	// counting shims if counting is on.
+	if (OCIInitialize(
+			(ub4) OCI_OBJECT | (thr ? OCI_THREADED : 0),	// mode
+			counting ? 0 : user_ctx,			// user-def memory ptr
+			counting ? count_alloc : user_alloc,		// user-def memory alloc function
+			counting ? count_realloc : user_realloc,	// user-def memory realloc function
+			counting ? count_free : user_free))		// user-def memory free function
+		return;
+
+	// initialize the OCI environment handle
+	if (OCIEnvInit(	&env_h,						// ptr to env handle inited
+			(ub4) OCI_DEFAULT,				// mode
+			(size_t) 0,					// user memory size
+			(dvoid**) 0))					// user memory ptr
+		return;
+
+	// allocate an error handle, used only where no Connection is at hand
+	if (OCIHandleAlloc(
+			(dvoid*) env_h,
+			(dvoid**) &err_h,
+			(ub4) OCI_HTYPE_ERROR,
+			(size_t) 0,
+			(dvoid**) 0))
+		return;
+
+	if (pthread_key_create(&err_key, free_err))
+		return;
+	inited = true;
+}
+
+
+OCIError*
+Oracle::Env::thread_err() throw(Oracle::Error)
+{
+	// Value types (Number, Date) use a handle of their own per thread, so
+	// arithmetic and conversions in worker threads don't share err_h.
+	init();
+	OCIError* h = (OCIError*) pthread_getspecific(err_key);
+	if (!h)
 	{
-		// Initialize the OCI process just once.
-		// Any class which calls OCI functions must contain a static Env object
-		// to ensure the OCI environment is initialized.
-		if (OCIInitialize(
-				(ub4) OCI_OBJECT,				// mode
-				(dvoid*) 0,					// user-def memory ptr
-				0,						// user-def memory alloc function
-				0,						// user-def memory realloc function
-				0))						// user-def memory free function
-			throw Error("Env::Env", "Could not initialize Oracle environment", __FILE__, __LINE__);
-
-		// initialize the OCI environment handle
-		if (OCIEnvInit(	&env_h,						// ptr to env handle inited
-				(ub4) OCI_DEFAULT,				// mode
-				(size_t) 0,					// user memory size
-				(dvoid**) 0))					// user memory ptr
-			throw Error("Env::Env", "Could not initialize Oracle environment", __FILE__, __LINE__);
-
-		// allocate an error handle
 		if (OCIHandleAlloc(
 				(dvoid*) env_h,
-				(dvoid**) &err_h,
+				(dvoid**) &h,
 				(ub4) OCI_HTYPE_ERROR,
 				(size_t) 0,
 				(dvoid**) 0))
-			throw Error("Env::Env", "Could not initialize Oracle environment", __FILE__, __LINE__);
-		inited = true;
+			throw Error("Env::thread_err", "Could not allocate an error handle", __FILE__, __LINE__);
+		pthread_setspecific(err_key, h);
 	}
+	return h;
+}
+
+
+void
+Oracle::Env::free_err(void* h)
+{
+	OCIHandleFree((dvoid*) h, (ub4) OCI_HTYPE_ERROR);
+}
+
+
+double
+Oracle::Env::now() throw()
+{
+	struct timeval tv;
+	gettimeofday(&tv, 0);
+	return tv.tv_sec + tv.tv_usec / 1e6;
 }
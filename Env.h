@@ -22,6 +22,9 @@
 #ifndef ORAPP_ENV_H
 #define ORAPP_ENV_H
 
+#include <pthread.h>
+#include <cstddef>
+
 class OCIEnv;
 class OCIError;
 
@@ -31,29 +34,86 @@ namespace Oracle
 	class Date;
 	class Number;
 	
+	// The OCI environment is created on first use, not when the static Env
+	// objects are constructed, so that it can be configured beforehand.
 	class Env
 	{
 		public:
+			// types
+			typedef void* (*alloc_fn)(void*, size_t);		// OCI malloc callback
+			typedef void* (*realloc_fn)(void*, void*, size_t);	// OCI realloc callback
+			typedef void (*free_fn)(void*, void*);			// OCI free callback
+
 			// constructor/destructor
-			Env()				throw(Error);
+			Env()				throw(Error)
+				{}
 			~Env()				throw()
 				{}
+
+			// implementors
+			static void set_threaded(const bool)	throw(Error);	// OCI_THREADED on/off (default on)
+			static void set_allocator(				// memory callbacks for OCI (default malloc)
+				alloc_fn,						// allocate
+				realloc_fn,						// reallocate
+				free_fn,						// free
+				void* = 0)			throw(Error);	// context passed to callbacks
+			static void set_counting(const bool)	throw(Error);	// count OCI memory use (default off)
+
+			// accessors
+			static bool threaded()		throw()		// threaded mode requested
+				{ return thr; }
+			static long alloc_calls()	throw()		// OCI allocations
+				{ return n_alloc; }
+			static long realloc_calls()	throw()		// OCI reallocations
+				{ return n_realloc; }
+			static long free_calls()	throw()		// OCI frees
+				{ return n_free; }
+			static long bytes_allocated()	throw()		// total bytes requested by OCI
+				{ return n_bytes; }
+			static long bytes_in_use()	throw()		// bytes allocated, not yet freed
+				{ return n_in_use; }
+			static double now()		throw();	// wall clock time in seconds
 			
 		private:
 			// implementors
-			static OCIEnv* env()		throw()
-				{ return env_h; }
-			static OCIError* err()		throw()
-				{ return err_h; }
+			static OCIEnv* env()		throw(Error)
+				{ init(); return env_h; }
+			static OCIError* err()		throw(Error)
+				{ init(); return err_h; }
+			static OCIError* thread_err()	throw(Error);	// calling thread's own error handle
+			static void free_err(void*);			// frees a thread's handle at exit
+			static void init()		throw(Error);	// initialize once, thread-safe
+			static void do_init()		throw();	// pthread_once routine
+			static void* count_alloc(void*, size_t);		// counting shims
+			static void* count_realloc(void*, void*, size_t);
+			static void count_free(void*, void*);
 		
 			// data members
+			static pthread_once_t once;
+			static pthread_key_t err_key;				// per-thread error handles
 			static bool inited;
+			static bool thr;
 			static OCIEnv* env_h;
 			static OCIError* err_h;
+			static alloc_fn user_alloc;				// installed callbacks (0==malloc)
+			static realloc_fn user_realloc;
+			static free_fn user_free;
+			static void* user_ctx;
+			static bool counting;
+			static long n_alloc;					// counters, updated atomically
+			static long n_realloc;
+			static long n_free;
+			static long n_bytes;
+			static long n_in_use;
 			
 		friend class Connection;
+		friend class Connection_Pool;
+		friend class Pooled_Connection;
+		friend class Bulk_Open;
+		friend class Select_Stmt;
 		friend class Date;
 		friend class Number;
+		friend class Number_Array;
 		friend class Cursor;
 	};
 	
@@ -0,0 +1,123 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Ora++ -- a C++ interface to Oracle based on the Oracle Call Interface
+// Copyright (C) 2000-1 James Edwin Cain <me@jimcain.net>
+// 
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or any
+// later version.
+// 
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef ORAPP_FIELD_H
+#define ORAPP_FIELD_H
+
+#include "Nullable.h"
+
+
+namespace Oracle
+{
+	// Plain host variables for Select_Stmt::bind_row().  Unlike the Nullable
+	// classes they have no virtual functions and no heap storage; the OCI
+	// external type and buffer size come from the C++ type at compile time.
+
+	template <class T> struct Field_Traits;					// only the types below may be fetched
+
+	template <> struct Field_Traits<int>
+		{ enum { sqlt = 3, size = sizeof(int) }; };			// SQLT_INT
+	template <> struct Field_Traits<long>
+		{ enum { sqlt = 3, size = sizeof(long) }; };			// SQLT_INT
+	template <> struct Field_Traits<unsigned int>
+		{ enum { sqlt = 68, size = sizeof(unsigned int) }; };		// SQLT_UIN
+	template <> struct Field_Traits<float>
+		{ enum { sqlt = 4, size = sizeof(float) }; };			// SQLT_FLT
+	template <> struct Field_Traits<double>
+		{ enum { sqlt = 4, size = sizeof(double) }; };			// SQLT_FLT
+
+	template <class T>
+	class Field
+	{
+		public:
+			// constructor
+			Field()						throw()
+				: val(), ind(-1), len(0) {}
+
+			// accessors
+			bool is_null() const				throw()
+				{ return ind == -1; }
+			const T& value() const				throw()		// value (undefined if NULL)
+				{ return val; }
+			T value(const T& d) const			throw()		// value or given value if NULL
+				{ return ind == -1 ? d : val; }
+
+			// data members
+			T val;
+			sb2 ind;							// null indicator
+			ub2 len;							// returned length
+	};
+
+	// A string of at most N characters, fetched without a terminator.
+	template <int N>
+	class Char_Field
+	{
+		public:
+			// constructor
+			Char_Field()					throw()
+				: ind(-1), len(0) {}
+
+			// accessors
+			bool is_null() const				throw()
+				{ return ind == -1; }
+			Str_View view() const				throw()		// characters (empty if NULL)
+				{ return Str_View(buf, ind == -1 ? 0 : len); }
+			std::string str(const std::string& d = "") const throw()	// copy or given string if NULL
+				{ return ind == -1 ? d : std::string(buf, len); }
+
+			// data members
+			char buf[N];
+			sb2 ind;							// null indicator
+			ub2 len;							// returned length
+	};
+
+	// A date in Oracle's 7-byte internal format (SQLT_DAT).
+	class Date_Field
+	{
+		public:
+			// constructor
+			Date_Field()					throw()
+				: ind(-1), len(0) {}
+
+			// accessors
+			bool is_null() const				throw()
+				{ return ind == -1; }
+			int year() const				throw()
+				{ return (d[0] - 100) * 100 + d[1] - 100; }
+			int month() const				throw()
+				{ return d[2]; }
+			int day() const					throw()
+				{ return d[3]; }
+			int hour() const				throw()
+				{ return d[4] - 1; }
+			int minute() const				throw()
+				{ return d[5] - 1; }
+			int second() const				throw()
+				{ return d[6] - 1; }
+
+			// data members
+			unsigned char d[7];
+			sb2 ind;							// null indicator
+			ub2 len;							// returned length
+	};
+}
+
+#endif
@@ -0,0 +1,132 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Ora++ -- a C++ interface to Oracle based on the Oracle Call Interface
+// Copyright (C) 2000-1 James Edwin Cain <me@jimcain.net>
+// 
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or any
+// later version.
+// 
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Name_Index.h"
+#include <cstring>
+
+
+Oracle::Name_Index::Name_Index() throw()
+{
+}
+
+
+void
+Oracle::Name_Index::add(const std::string& s, const int col) throw()
+{
+	// a later column with the same name replaces an earlier one
+	int i = lookup(s.data(), s.length());
+	if (i >= 0)
+	{
+		cols[i] = col;
+		return;
+	}
+
+	names.push_back(s);
+	cols.push_back(col);
+
+	// keep the table at most half full
+	if (names.size() * 2 > slot.size())
+		grow();
+	else
+	{
+		unsigned long mask = slot.size() - 1;
+		unsigned long h = hash(s.data(), s.length()) & mask;
+		while (slot[h] != -1)
+			h = (h + 1) & mask;
+		slot[h] = names.size() - 1;
+	}
+}
+
+
+void
+Oracle::Name_Index::clear() throw()
+{
+	names.clear();
+	cols.clear();
+	slot.clear();
+}
+
+
+int
+Oracle::Name_Index::find(const char* s) const throw()
+{
+	int i = lookup(s, std::strlen(s));
+	return i < 0 ? -1 : cols[i];
+}
+
+
+int
+Oracle::Name_Index::find(const std::string& s) const throw()
+{
+	int i = lookup(s.data(), s.length());
+	return i < 0 ? -1 : cols[i];
+}
+
+
+unsigned long
+Oracle::Name_Index::hash(const char* s, const int n) throw()
+{
+	unsigned long h = 2166136261UL;
+	for (int i=0; i < n; i++)
+	{
+		h ^= (unsigned char) s[i];
+		h *= 16777619UL;
+	}
+	return h;
+}
+
+
+int
+Oracle::Name_Index::lookup(const char* s, const int n) const throw()
+{
+	if (slot.empty())
+		return -1;
+
+	// probe linearly from the home slot until the name or an empty slot is found
+	unsigned long mask = slot.size() - 1;
+	for (unsigned long h = hash(s, n) & mask; slot[h] != -1; h = (h + 1) & mask)
+	{
+		const std::string& name = names[slot[h]];
+		if (name.length() == n && std::memcmp(name.data(), s, n) == 0)
+			return slot[h];
+	}
+	return -1;
+}
+
+
+void
+Oracle::Name_Index::grow() throw()
+{
+	// double the table (minimum 16 slots) and reinsert every name
+	unsigned long size = slot.size() ? slot.size() * 2 : 16;
+	while (size < names.size() * 2)
+		size *= 2;
+	slot.assign(size, -1);
+
+	unsigned long mask = size - 1;
+	for (int i=0; i < names.size(); i++)
+	{
+		unsigned long h = hash(names[i].data(), names[i].length()) & mask;
+		while (slot[h] != -1)
+			h = (h + 1) & mask;
+		slot[h] = i;
+	}
+}
@@ -0,0 +1,67 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Ora++ -- a C++ interface to Oracle based on the Oracle Call Interface
+// Copyright (C) 2000-1 James Edwin Cain <me@jimcain.net>
+// 
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or any
+// later version.
+// 
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef ORAPP_NAME_INDEX_H
+#define ORAPP_NAME_INDEX_H
+
+#include <string>
+#include <vector>
+
+
+namespace Oracle
+{
+	// A column resolved ahead of time by Select_Stmt::resolve() or
+	// Rowtype::resolve(), so that operator[] needs no name lookup.
+	struct Col_Handle
+	{
+		explicit Col_Handle(const int p = -1) : pos(p) {}
+		int pos;							// column number (zero-based)
+	};
+
+	// Open-addressed hash table mapping column names to column numbers.
+	class Name_Index
+	{
+		public:
+			// constructor
+			Name_Index()					throw();
+
+			// implementors
+			void add(const std::string&, const int)		throw();	// add name -> column number
+			void clear()					throw();
+
+			// accessors
+			int find(const char*) const			throw();	// column number or -1
+			int find(const std::string&) const		throw();	// column number or -1
+
+		private:
+			// internal functions
+			static unsigned long hash(const char*, const int) throw();
+			int lookup(const char*, const int) const	throw();
+			void grow()					throw();
+
+			// data members
+			std::vector<std::string> names;					// names in insertion order
+			std::vector<int> cols;						// column numbers in insertion order
+			std::vector<int> slot;						// index into names, or -1 if empty
+	};
+}
+
+#endif
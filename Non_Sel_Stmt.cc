@@ -21,28 +21,34 @@
 
 #include "Non_Sel_Stmt.h"
 #include "Connection.h"
+#include "Nullable.h"
+#include "Nullable_Array.h"
 #include <oci.h>
+#include <cstring>
 
 
 Oracle::Non_Sel_Stmt::Non_Sel_Stmt(OCIStmt* stmt_hdl, char* stmt_ptr, OCISvcCtx* svc_hdl, OCIError* err_hdl) throw()
-	: Stmt(stmt_hdl, stmt_ptr, svc_hdl, err_hdl)
+	: Stmt(stmt_hdl, stmt_ptr, svc_hdl, err_hdl), batch_sz(1), batch_n(0), batch_rows(0),
+	  batch_base(0), batch_err(false), commit_ok(false), exec_mode(0), exec_commit(false)
 {
 }
 
 
 Oracle::Non_Sel_Stmt::Non_Sel_Stmt(Connection& db) throw(Oracle::Error)
-	: Stmt(db)
+	: Stmt(db), batch_sz(1), batch_n(0), batch_rows(0),
+	  batch_base(0), batch_err(false), commit_ok(false), exec_mode(0), exec_commit(false)
 {
 }
 
 
 Oracle::Non_Sel_Stmt::Non_Sel_Stmt(Connection& db, const std::string& sql) throw(Oracle::Error)
-	: Stmt(db, sql)
+	: Stmt(db, sql), batch_sz(1), batch_n(0), batch_rows(0),
+	  batch_base(0), batch_err(false), commit_ok(false), exec_mode(0), exec_commit(false)
 {
 	// make sure this is actually a non-SELECT statement
 	if (oci_type() == OCI_STMT_SELECT)
 	{
-		OCIHandleFree((dvoid *)stmt_h, (ub4)OCI_HTYPE_STMT);
+		free_handle();
 		delete stmt_p;
 		st = Invalid;
 		Type_Error e("Non_Sel_Stmt::Non_Sel_Stmt", "Statement is not a non-SELECT statement");
@@ -52,8 +58,550 @@ Oracle::Non_Sel_Stmt::Non_Sel_Stmt(Connection& db, const std::string& sql) throw
 }
 
 
+Oracle::Non_Sel_Stmt::~Non_Sel_Stmt() throw()
+{
+	if (st > Closed)
+		close();
+}
+
+
 void
 Oracle::Non_Sel_Stmt::exec() throw(Oracle::Error)
 {
-	do_exec(1);
+	if (batch_sz == 1)
+	{
+		if (!busy_)
+			clear_returned();
+		exec_rows(1, 0);
+		return;
+	}
+
+	// a staged row is not a call that can be polled
+	if (async_)
+	{
+		State_Error e("Non_Sel_Stmt::exec()", "exec_async() cannot be used while batching");
+		if (stmt_p)
+			e.desc << "statement = {" << stmt_p << "}";
+		throw e;
+	}
+
+	// copy the current values of the bound objects into the next row of
+	// the staging arrays, and execute when the arrays are full
+	if (stage_v.empty())
+		init_stage();
+
+	for (int i=0; i < stage_v.size(); i++)
+	{
+		Nullable& v = *bind_v[i].var;
+		Stage& s = stage_v[i];
+		if (v.maxsize() > s.width)
+		{
+			Value_Error e("Non_Sel_Stmt::exec()", "Value is larger than when batching started");
+			e.desc << "size = " << v.maxsize() << "; staged size = " << s.width;
+			if (stmt_p)
+				e.desc << "; statement = {" << stmt_p << "}";
+			throw e;
+		}
+		std::memcpy(s.buf + batch_n * s.width, v.data(), v.maxsize());
+		s.ind[batch_n] = v.indicator();
+		s.len[batch_n] = v.len_addr() ? *v.len_addr() : v.maxsize();
+	}
+
+	if (++batch_n == batch_sz)
+		flush();
+}
+
+
+void
+Oracle::Non_Sel_Stmt::set_batch_size(const int n) throw(Oracle::Error)
+{
+	if (n < 1)
+	{
+		Value_Error e("Non_Sel_Stmt::set_batch_size(const int)", "Batch size must be at least 1");
+		e.desc << "size = " << n;
+		throw e;
+	}
+	if (stage_v.size())
+	{
+		State_Error e("Non_Sel_Stmt::set_batch_size(const int)", "Batching has already started");
+		if (stmt_p)
+			e.desc << "statement = {" << stmt_p << "}";
+		throw e;
+	}
+	batch_sz = n;
+}
+
+
+void
+Oracle::Non_Sel_Stmt::init_stage() throw(Oracle::Error)
+{
+	if (arr_rows)
+	{
+		State_Error e("Non_Sel_Stmt::init_stage()", "Cannot batch a statement with array binds");
+		if (stmt_p)
+			e.desc << "statement = {" << stmt_p << "}";
+		throw e;
+	}
+
+	// Rebinding a placeholder replaces the earlier bind, so each bound
+	// object is moved to a staging array as wide as its current value.
+	stage_v.resize(bind_v.size());
+	for (int i=0; i < stage_v.size(); i++)
+	{
+		Stage& s = stage_v[i];
+		s.width = bind_v[i].var->maxsize();
+		s.buf = new char[batch_sz * s.width];
+		s.ind = new sb2[batch_sz];
+		s.len = new ub2[batch_sz];
+	}
+
+	for (int i=0; i < stage_v.size(); i++)
+	{
+		Stage& s = stage_v[i];
+		OCIBind* bind_h = 0;
+		sword rc;
+		if (bind_v[i].name.empty())
+			rc = OCIBindByPos(stmt_h,
+					&bind_h,
+					err_h,
+					(ub4) bind_v[i].pos,
+					(dvoid*) s.buf,
+					(sb4) s.width,
+					(ub2) bind_v[i].var->sqlt(),
+					(dvoid*) s.ind,
+					(ub2*) s.len,
+					(ub2*) 0,
+					(ub4) 0,
+					(ub4*) 0,
+					OCI_DEFAULT);
+		else
+			rc = OCIBindByName(stmt_h,
+					&bind_h,
+					err_h,
+					(CONST text*) bind_v[i].name.c_str(),
+					(sb4) bind_v[i].name.length(),
+					(dvoid*) s.buf,
+					(sb4) s.width,
+					(ub2) bind_v[i].var->sqlt(),
+					(dvoid*) s.ind,
+					(ub2*) s.len,
+					(ub2*) 0,
+					(ub4) 0,
+					(ub4*) 0,
+					OCI_DEFAULT);
+		if (rc || OCIBindArrayOfStruct(
+				bind_h,							// bind handle
+				err_h,							// error handle
+				(ub4) s.width,						// value skip
+				(ub4) sizeof(sb2),					// indicator skip
+				(ub4) sizeof(ub2),					// length skip
+				(ub4) 0))						// return code skip
+		{
+			OCI_Error e("Non_Sel_Stmt::init_stage()", err_h);
+			e.desc << "bind = " << i + 1;
+			if (stmt_p)
+				e.desc << "; statement = {" << stmt_p << "}";
+			throw e;
+		}
+	}
+
+	// let commit() flush this statement
+	if (db_)
+		db_->add_batch(this);
+}
+
+
+void
+Oracle::Non_Sel_Stmt::flush() throw(Oracle::Error)
+{
+	if (!batch_n)
+		return;
+
+	// the batch is gone whether or not it succeeds; rejected rows are
+	// numbered from the first row staged, returned rows from the first
+	// row of this batch
+	int n = batch_n;
+	int base = batch_base;
+	batch_n = 0;
+	batch_base += n;
+	clear_returned();
+	exec_rows(n, base);
+	batch_rows += Stmt::nrows();
+}
+
+
+void
+Oracle::Non_Sel_Stmt::discard() throw()
+{
+	batch_base += batch_n;
+	batch_n = 0;
+}
+
+
+int
+Oracle::Non_Sel_Stmt::nrows() const throw(Oracle::Error)
+{
+	if (batch_sz == 1)
+		return Stmt::nrows();
+	return batch_rows;
+}
+
+
+void
+Oracle::Non_Sel_Stmt::free_stage() throw()
+{
+	for (int i=0; i < stage_v.size(); i++)
+	{
+		delete [] stage_v[i].buf;
+		delete [] stage_v[i].ind;
+		delete [] stage_v[i].len;
+	}
+	stage_v.clear();
+}
+
+
+void
+Oracle::Non_Sel_Stmt::close() throw()
+{
+	// ignore if already closed
+	if (st == Closed)
+		return;
+
+	// Staged rows are part of the transaction, so they are sent rather
+	// than dropped (only rollback() drops them).  close() cannot throw;
+	// if the rows cannot be sent, the Connection's next commit() raises
+	// the error instead.
+	if (batch_n && !busy_)
+	{
+		bool a = async_;
+		async_ = false;
+		try
+		{
+			flush();
+		}
+		catch (Error& e)
+		{
+			if (db_)
+				db_->batch_failed(e);
+		}
+		async_ = a;
+	}
+
+	if (stage_v.size() && db_)
+		db_->remove_batch(this);
+	free_stage();
+	for (int r=0; r < ret_v.size(); r++)
+	{
+		delete [] ret_v[r]->alen;
+		delete [] ret_v[r]->rcode;
+		delete [] ret_v[r]->spare;
+		delete ret_v[r];
+	}
+	ret_v.clear();
+	batch_n = 0;
+	Stmt::close();
+}
+
+
+void
+Oracle::Non_Sel_Stmt::exec_batch(const int rows) throw(Oracle::Error)
+{
+	// Every bind variable must be a Nullable_Array; row i of the batch
+	// uses element i of each array.
+	if (!arr_rows)
+	{
+		State_Error e("Non_Sel_Stmt::exec_batch(const int)", "No arrays are bound");
+		if (stmt_p)
+			e.desc << "statement = {" << stmt_p << "}";
+		throw e;
+	}
+	if (rows < 1 || rows > arr_rows)
+	{
+		Value_Error e("Non_Sel_Stmt::exec_batch(const int)", "Row count out of range");
+		e.desc << "rows = " << rows << "; array size = " << arr_rows;
+		if (stmt_p)
+			e.desc << "; statement = {" << stmt_p << "}";
+		throw e;
+	}
+	row_err_v.clear();
+	clear_returned();
+	exec_rows(rows, 0);
+}
+
+
+void
+Oracle::Non_Sel_Stmt::exec_rows(const int rows, const int base) throw(Oracle::Error)
+{
+	// Rows that fail can be reported rather than failing the execute,
+	// and the commit can ride on the execute rather than taking its own
+	// round trip, unless the Connection has other work that commit()
+	// must see first; then commit() follows the execute.  A call still
+	// executing is repeated with the mode it started with.
+	if (!busy_)
+	{
+		exec_mode = 0;
+		exec_commit = false;
+		if (batch_err)
+			exec_mode |= OCI_BATCH_ERRORS;
+		if (commit_ok || (db_ && db_->commit_due(rows)))
+		{
+			if (!db_ || db_->commit_alone(this))
+				exec_mode |= OCI_COMMIT_ON_SUCCESS;
+			else
+				exec_commit = true;
+		}
+	}
+	const unsigned mode = exec_mode;
+
+	if (!do_exec(rows, mode))
+		return;
+	if (batch_err)
+		get_row_errors(base);
+
+	if (db_)
+	{
+		if (mode & OCI_COMMIT_ON_SUCCESS)
+			db_->committed();
+		else
+			db_->add_rows(rows);
+		if (exec_commit)
+			db_->commit();
+	}
+	end_returned();
+}
+
+
+void
+Oracle::Non_Sel_Stmt::bind_returning(Nullable_Array& arr, const std::string& label) throw(Oracle::Error)
+{
+	// check state
+	if (st == Initialized)
+	{
+		if (std::ostringstream::str().length())
+			prepare(std::ostringstream::str());
+		else
+			throw State_Error("Non_Sel_Stmt::bind_returning", "No statement text has been specified");
+	}
+	else if (st > Prepared)
+	{
+		State_Error e("Non_Sel_Stmt::bind_returning", "Cannot bind after execution");
+		if (stmt_p)
+			e.desc << "statement = {" << stmt_p << "}";
+		throw e;
+	}
+
+	Ret_Bind* rb = new Ret_Bind;
+	rb->arr = &arr;
+	rb->alen = new ub4[arr.size()];
+	rb->rcode = new ub2[arr.size()];
+	rb->spare = new char[arr.width()];
+	rb->next = 0;
+	rb->lost = 0;
+	ret_v.push_back(rb);
+
+	// values are supplied by the callbacks as the rows are returned
+	OCIBind* bind_h = 0;
+	if (OCIBindByName(stmt_h,
+			&bind_h,
+			err_h,
+			(CONST text*) label.c_str(),
+			(sb4) label.length(),
+			(dvoid*) 0,
+			(sb4) arr.width(),
+			(ub2) arr.sqlt(),
+			(dvoid*) 0,
+			(ub2*) 0,
+			(ub2*) 0,
+			(ub4) 0,
+			(ub4*) 0,
+			OCI_DATA_AT_EXEC)
+		|| OCIBindDynamic(
+			bind_h,								// bind handle
+			err_h,								// error handle
+			(dvoid*) rb,							// in context
+			ret_in,								// in callback
+			(dvoid*) rb,							// out context
+			ret_out))							// out callback
+	{
+		OCI_Error e("Non_Sel_Stmt::bind_returning", err_h);
+		e.desc << "placeholder = " << label;
+		if (stmt_p)
+			e.desc << "; statement = {" << stmt_p << "}";
+		throw e;
+	}
+	bind_l.push_back(bind_h);
+}
+
+
+sb4
+Oracle::Non_Sel_Stmt::ret_in(void*, OCIBind*, ub4, ub4, void** bufpp, ub4* alenp, ub1* piecep, void** indpp)
+{
+	// a RETURNING placeholder takes no input
+	static sb2 null_ind = -1;
+	*bufpp = 0;
+	*alenp = 0;
+	*indpp = (void*) &null_ind;
+	*piecep = OCI_ONE_PIECE;
+	return OCI_CONTINUE;
+}
+
+
+sb4
+Oracle::Non_Sel_Stmt::ret_out(void* ctx, OCIBind*, ub4, ub4, void** bufpp, ub4** alenpp, ub1* piecep,
+	void** indpp, ub2** rcodepp)
+{
+	// returned rows fill the array in order; any beyond its end are
+	// counted and dropped
+	Ret_Bind* rb = (Ret_Bind*) ctx;
+	Nullable_Array& a = *rb->arr;
+	int i = rb->next++;
+	if (i < a.size())
+	{
+		rb->alen[i] = a.width();
+		*bufpp = (char*) a.data() + i * a.width();
+		*alenpp = &rb->alen[i];
+		*indpp = (void*) &a.ind[i];
+		*rcodepp = &rb->rcode[i];
+	}
+	else
+	{
+		static ub4 spare_len;
+		static sb2 spare_ind;
+		static ub2 spare_rcode;
+		rb->lost++;
+		spare_len = a.width();
+		*bufpp = rb->spare;
+		*alenpp = &spare_len;
+		*indpp = (void*) &spare_ind;
+		*rcodepp = &spare_rcode;
+	}
+	*piecep = OCI_ONE_PIECE;
+	return OCI_CONTINUE;
+}
+
+
+void
+Oracle::Non_Sel_Stmt::end_returned() throw(Oracle::Error)
+{
+	int lost = 0;
+	for (int r=0; r < ret_v.size(); r++)
+	{
+		Ret_Bind* rb = ret_v[r];
+		int n = rb->next < rb->arr->size() ? rb->next : rb->arr->size();
+		for (int i=0; i < n; i++)
+			rb->arr->len[i] = rb->alen[i];
+		lost += rb->lost;
+		rb->lost = 0;
+	}
+	if (lost)
+	{
+		Value_Error e("Non_Sel_Stmt::end_returned()", "More rows were returned than the arrays hold");
+		e.desc << "values lost = " << lost;
+		if (stmt_p)
+			e.desc << "; statement = {" << stmt_p << "}";
+		throw e;
+	}
+}
+
+
+void
+Oracle::Non_Sel_Stmt::clear_returned() throw()
+{
+	for (int r=0; r < ret_v.size(); r++)
+	{
+		ret_v[r]->next = 0;
+		ret_v[r]->lost = 0;
+	}
+}
+
+
+int
+Oracle::Non_Sel_Stmt::nreturned() const throw()
+{
+	if (ret_v.empty())
+		return 0;
+	return ret_v[0]->next < ret_v[0]->arr->size() ? ret_v[0]->next : ret_v[0]->arr->size();
+}
+
+
+void
+Oracle::Non_Sel_Stmt::set_batch_errors(const bool on) throw(Oracle::Error)
+{
+	if (on && !db_)
+		throw State_Error("Non_Sel_Stmt::set_batch_errors(const bool)", "Statement has no Connection");
+	batch_err = on;
+}
+
+
+void
+Oracle::Non_Sel_Stmt::clear_row_errors() throw()
+{
+	row_err_v.clear();
+}
+
+
+void
+Oracle::Non_Sel_Stmt::get_row_errors(const int base) throw(Oracle::Error)
+{
+	ub4 num = 0;
+	if (OCIAttrGet(	(dvoid *) stmt_h,					// statement handle
+			(ub4) OCI_HTYPE_STMT,					// handle type
+			(dvoid *) &num,						// returned value
+			(ub4 *) 0,						// output size (0==default)
+			(ub4) OCI_ATTR_NUM_DML_ERRORS,				// attribute to return
+			err_h))							// error handle
+	{
+		OCI_Error e("Non_Sel_Stmt::get_row_errors(const int)", err_h);
+		if (stmt_p)
+			e.desc << "statement = {" << stmt_p << "}";
+		throw e;
+	}
+	if (!num)
+		return;
+
+	// each rejected row has its own error record, read through a
+	// separate error handle
+	OCIError* row_err_h = 0;
+	if (OCIHandleAlloc(
+			(dvoid *) db_->env_handle(),				// env handle
+			(dvoid **) &row_err_h,					// handle returned
+			(ub4) OCI_HTYPE_ERROR,					// handle type
+			(size_t) 0,						// user-def memory size
+			(dvoid **) 0))						// user-def memory ptr
+		throw Error("Non_Sel_Stmt::get_row_errors(const int)", "OCIHandleAlloc failed for error handle");
+
+	const int max_size = 512;
+	text buf[max_size];
+	for (ub4 i=0; i < num; i++)
+	{
+		Row_Error re;
+		ub4 off = 0;
+		sb4 code = 0;
+		if (OCIParamGet((dvoid *) err_h, (ub4) OCI_HTYPE_ERROR, err_h, (dvoid **) &row_err_h, i)
+			|| OCIAttrGet((dvoid *) row_err_h, (ub4) OCI_HTYPE_ERROR,
+				(dvoid *) &off, (ub4 *) 0, (ub4) OCI_ATTR_DML_ROW_OFFSET, err_h))
+		{
+			OCI_Error e("Non_Sel_Stmt::get_row_errors(const int)", err_h);
+			OCIHandleFree((dvoid *) row_err_h, (ub4) OCI_HTYPE_ERROR);
+			if (stmt_p)
+				e.desc << "statement = {" << stmt_p << "}";
+			throw e;
+		}
+		buf[0] = 0;
+		OCIErrorGet((dvoid *) row_err_h,				// error handle
+				(ub4) 1,					// record number
+				(text *) 0,					// reserved
+				&code,						// error code
+				buf,						// error message
+				(ub4) max_size,					// size of error msg buffer
+				(ub4) OCI_HTYPE_ERROR);				// handle type
+
+		re.row = base + off;
+		re.ora_code = code;
+		re.msg = (char*) buf;
+		if (re.msg.length() && re.msg[re.msg.length() - 1] == '\n')
+			re.msg.erase(re.msg.length() - 1);
+		row_err_v.push_back(re);
+	}
+	OCIHandleFree((dvoid *) row_err_h, (ub4) OCI_HTYPE_ERROR);
 }
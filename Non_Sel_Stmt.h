@@ -23,32 +23,104 @@
 #define ORAPP_NON_SEL_STMT_H
 
 #include "Stmt.h"
+#include "Nullable.h"
+#include <vector>
 
 
 namespace Oracle
 {
 	class Connection;
 	class Nullable;
+	class Nullable_Array;
 	class Rowtype;
 
 	class Non_Sel_Stmt: public Stmt
 	{
 		public:
+			// types
+			struct Row_Error						// a row rejected in batch error mode
+			{
+				int row;						// row in batch (zero-based)
+				int ora_code;						// Oracle error code
+				std::string msg;					// error message
+			};
+
 			// constructors/destructor
 			Non_Sel_Stmt(Connection&)			throw(Error);	// use this Connection
 			Non_Sel_Stmt(
 				Connection&,						// use this Connection
 				const std::string&)			throw(Error);	// statement text
-			virtual ~Non_Sel_Stmt() {}
+			virtual ~Non_Sel_Stmt()				throw();
 
 			// implementors
-			virtual void exec()				throw(Error);
+			virtual void exec()				throw(Error);	// execute, or stage row if batching
+			void exec_batch(const int)			throw(Error);	// execute for rows of bound arrays
+			void set_batch_size(const int)			throw(Error);	// rows staged per execute (1==off)
+			void flush()					throw(Error);	// execute staged rows
+			void set_batch_errors(const bool)		throw(Error);	// report bad rows instead of failing
+			void set_commit_on_success(const bool on)	throw()		// commit with each execute
+				{ commit_ok = on; }
+			void clear_row_errors()				throw();	// forget rejected rows
+			void bind_returning(						// receive RETURNING ... INTO values
+				Nullable_Array&,					// array to fill
+				const std::string&)			throw(Error);	// placeholder name
+			void clear_returned()				throw();	// refill arrays from the start
+			virtual void close()				throw();	// staged rows are flushed
 
 			// accessors
 			virtual stmt_t type() const					// statement type
 				{ return Non_Select; }
+			virtual int nrows() const			throw(Error);	// rows affected (summed over batches)
+			int batch_size() const				throw()		// rows staged per execute
+				{ return batch_sz; }
+			int pending() const				throw()		// rows staged, not yet executed
+				{ return batch_n; }
+			const std::vector<Row_Error>& row_errors() const throw()	// rows rejected in batch error mode
+				{ return row_err_v; }
+			int nreturned() const				throw();	// rows in RETURNING arrays
 		
 		protected:
+			// types
+			struct Ret_Bind							// a RETURNING ... INTO bind
+			{
+				Nullable_Array* arr;					// array receiving values
+				ub4* alen;						// returned lengths
+				ub2* rcode;						// column return codes
+				char* spare;						// target for rows beyond arr
+				int next;						// next element to fill
+				int lost;						// rows beyond arr
+			};
+			struct Stage							// staging array for one bind
+			{
+				char* buf;						// values
+				sb2* ind;						// null indicators
+				ub2* len;						// value lengths
+				int width;						// size of one value
+			};
+
+			// protected implementors
+			void init_stage()				throw(Error);	// rebind to staging arrays
+			void free_stage()				throw();
+			void discard()					throw();	// drop staged rows
+			void exec_rows(const int, const int)		throw(Error);	// execute array rows
+			void get_row_errors(const int)			throw(Error);	// collect rejected rows
+			void end_returned()				throw(Error);	// copy lengths, check overflow
+			static sb4 ret_in(void*, OCIBind*, ub4, ub4, void**, ub4*, ub1*, void**);
+			static sb4 ret_out(void*, OCIBind*, ub4, ub4, void**, ub4**, ub1*, void**, ub2**);
+
+			// data members
+			int batch_sz;							// rows staged per execute
+			int batch_n;							// rows staged
+			long batch_rows;						// rows affected by flushed batches
+			std::vector<Stage> stage_v;					// one per entry in bind_v
+			long batch_base;						// rows staged before current batch
+			bool batch_err;							// execute with OCI_BATCH_ERRORS
+			bool commit_ok;							// execute with OCI_COMMIT_ON_SUCCESS
+			unsigned exec_mode;						// mode of the execute in progress
+			bool exec_commit;						// call commit() after it
+			std::vector<Row_Error> row_err_v;				// rejected rows
+			std::vector<Ret_Bind*> ret_v;					// RETURNING binds
+
 			// protected constructors
 			Non_Sel_Stmt();
 			Non_Sel_Stmt(
@@ -58,6 +130,7 @@ namespace Oracle
 				OCIError* err_hdl)			throw();	// error handle
 		
 		friend class Connection;
+		friend class Copy_Pipeline;
 	};
 }
 
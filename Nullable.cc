@@ -21,6 +21,7 @@
 
 #include "Oracle.h"
 #include "Nullable.h"
+#include <cstring>
 #include <oci.h>
 
 
@@ -92,3 +93,53 @@ Oracle::Nullable::sqlt() const throw(Oracle::Error)
 {
 	throw Value_Error("Nullable::type", "A NULL has no type");
 }
+
+
+Oracle::Str_View
+Oracle::Nullable::view() const throw(Oracle::Error)
+{
+	throw Type_Error("Nullable::view()", "Only a Varchar can be viewed as characters");
+}
+
+
+unsigned long
+Oracle::Str_View::hash() const throw()
+{
+	unsigned long h = 2166136261UL;
+	for (int i=0; i < n; i++)
+	{
+		h ^= (unsigned char) p[i];
+		h *= 16777619UL;
+	}
+	return h;
+}
+
+
+bool
+Oracle::operator==(const Oracle::Str_View& a, const Oracle::Str_View& b) throw()
+{
+	return a.size() == b.size() && std::memcmp(a.data(), b.data(), a.size()) == 0;
+}
+
+
+bool
+Oracle::operator==(const Oracle::Str_View& a, const char* s) throw()
+{
+	// strncmp would stop at a NUL inside the view and then read past s
+	return std::strlen(s) == a.size() && std::memcmp(a.data(), s, a.size()) == 0;
+}
+
+
+bool
+Oracle::operator==(const Oracle::Str_View& a, const std::string& s) throw()
+{
+	return a.size() == s.length() && s.compare(0, s.length(), a.data(), a.size()) == 0;
+}
+
+
+bool
+Oracle::operator<(const Oracle::Str_View& a, const Oracle::Str_View& b) throw()
+{
+	int r = std::memcmp(a.data(), b.data(), a.size() < b.size() ? a.size() : b.size());
+	return r < 0 || (r == 0 && a.size() < b.size());
+}
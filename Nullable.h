@@ -26,12 +26,55 @@
 #include <iostream>
 
 typedef signed short sb2;	// an OCI type; define here so we don't have to include oci.h
+typedef unsigned short ub2;	// ditto
+typedef signed int sb4;		// ditto
+typedef unsigned int ub4;	// ditto
+typedef unsigned char ub1;	// ditto
 
 
 namespace Oracle
 {
 	class Stmt;
 	class Select_Stmt;
+
+	// A reference to characters held elsewhere (e.g. by a Varchar); valid
+	// until the owner is changed or the next row is fetched into it.
+	class Str_View
+	{
+		public:
+			// constructors
+			Str_View()					throw()
+				: p(""), n(0) {}
+			Str_View(const char* s, const int l)		throw()
+				: p(s), n(l) {}
+
+			// accessors
+			const char* data() const			throw()		// ptr to characters (not terminated)
+				{ return p; }
+			int size() const				throw()		// number of characters
+				{ return n; }
+			bool empty() const				throw()
+				{ return n == 0; }
+			char operator[](const int i) const		throw()
+				{ return p[i]; }
+			std::string str() const				throw()		// copy into a string
+				{ return std::string(p, n); }
+			unsigned long hash() const			throw();	// FNV-1a hash of the characters
+
+		private:
+			// data members
+			const char* p;
+			int n;
+	};
+
+	bool operator==(const Str_View&, const Str_View&)		throw();
+	bool operator==(const Str_View&, const char*)			throw();
+	bool operator==(const Str_View&, const std::string&)		throw();
+	inline bool operator!=(const Str_View& a, const Str_View& b)	throw()
+		{ return !(a == b); }
+	bool operator<(const Str_View&, const Str_View&)		throw();
+	inline std::ostream& operator<<(std::ostream& o, const Str_View& v)
+		{ return o.write(v.data(), v.size()); }
 	
 	class Nullable
 	{
@@ -56,6 +99,7 @@ namespace Oracle
 				const std::string&,						
 				const std::string&) const		throw();
 			virtual std::string sql_str() const 		throw();	// return a proper SQL string
+			virtual Str_View view() const			throw(Error);	// return characters without copying
 			virtual long lng() const			throw(Error);	// return a long
 			virtual long lng(const long) const		throw();	// return a long
 			virtual double dbl() const			throw(Error);	// return a double
@@ -73,9 +117,13 @@ namespace Oracle
 				{ return (void*)0; }
 			virtual sb2* ind_addr()				throw()		// ptr to null indicator
 				{ return &ind; }
+			virtual ub2* len_addr()				throw()		// ptr to returned length
+				{ return (ub2*)0; }
 
 		friend class Stmt;
 		friend class Select_Stmt;
+		friend class Non_Sel_Stmt;
+		friend class Parallel_Select;
 	};
 
 	inline std::ostream& operator<<(std::ostream& o, const Nullable& n)
@@ -0,0 +1,354 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Ora++ -- a C++ interface to Oracle based on the Oracle Call Interface
+// Copyright (C) 2000-1 James Edwin Cain <me@jimcain.net>
+// 
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or any
+// later version.
+// 
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Nullable_Array.h"
+#include "Number.h"
+#include "Date.h"
+#include <oci.h>
+#include <cstring>
+
+
+Oracle::Env Oracle::Number_Array::env;
+
+
+Oracle::Nullable_Array::Nullable_Array(const int sz) throw(Oracle::Error)
+	: n(sz), ind(0), len(0)
+{
+	if (n < 1)
+	{
+		Value_Error e("Nullable_Array::Nullable_Array(const int)", "Array size must be at least 1");
+		e.desc << "size = " << n;
+		throw e;
+	}
+	ind = new sb2[n];
+	len = new ub2[n];
+	set_null();
+}
+
+
+Oracle::Nullable_Array::~Nullable_Array() throw()
+{
+	delete [] ind;
+	delete [] len;
+}
+
+
+void
+Oracle::Nullable_Array::check(const int i, const char* module) const throw(Oracle::Error)
+{
+	if (i < 0 || i >= n)
+	{
+		Value_Error e(module, "Subscript out of range");
+		e.desc << "subscript = " << i << "; size = " << n;
+		throw e;
+	}
+}
+
+
+void
+Oracle::Nullable_Array::set_null(const int i) throw(Oracle::Error)
+{
+	check(i, "Nullable_Array::set_null(const int)");
+	ind[i] = -1;
+}
+
+
+void
+Oracle::Nullable_Array::set_null() throw()
+{
+	for (int i=0; i < n; i++)
+	{
+		ind[i] = -1;
+		len[i] = 0;
+	}
+}
+
+
+bool
+Oracle::Nullable_Array::is_null(const int i) const throw(Oracle::Error)
+{
+	check(i, "Nullable_Array::is_null(const int)");
+	return ind[i] == -1;
+}
+
+
+Oracle::Number_Array::Number_Array(const int sz) throw(Oracle::Error)
+	: Nullable_Array(sz), buf(new OCINumber[sz])
+{
+}
+
+
+Oracle::Number_Array::~Number_Array() throw()
+{
+	delete [] buf;
+}
+
+
+void
+Oracle::Number_Array::set(const int i, const long v) throw(Oracle::Error)
+{
+	check(i, "Number_Array::set(const int, const long)");
+	if (OCINumberFromInt(
+			env.thread_err(),					// error handle
+			(CONST dvoid*) &v,					// input integer
+			(uword) sizeof(long),					// input integer size
+			OCI_NUMBER_SIGNED,					// signed/unsigned
+			&buf[i]))						// OCINumber
+		throw OCI_Error("Number_Array::set(const int, const long)", env.thread_err());
+	ind[i] = 0;
+	len[i] = sizeof(OCINumber);
+}
+
+
+void
+Oracle::Number_Array::set(const int i, const double v) throw(Oracle::Error)
+{
+	check(i, "Number_Array::set(const int, const double)");
+	if (OCINumberFromReal(
+			env.thread_err(),					// error handle
+			(CONST dvoid*) &v,					// input double
+			(uword) sizeof(double),					// input double size
+			&buf[i]))						// OCINumber
+		throw OCI_Error("Number_Array::set(const int, const double)", env.thread_err());
+	ind[i] = 0;
+	len[i] = sizeof(OCINumber);
+}
+
+
+void
+Oracle::Number_Array::set(const int i, const Number& v) throw(Oracle::Error)
+{
+	check(i, "Number_Array::set(const int, const Number&)");
+	if (v.is_null())
+	{
+		ind[i] = -1;
+		return;
+	}
+	buf[i] = *v.num;
+	ind[i] = 0;
+	len[i] = sizeof(OCINumber);
+}
+
+
+Oracle::Number
+Oracle::Number_Array::get(const int i) const throw(Oracle::Error)
+{
+	check(i, "Number_Array::get(const int)");
+	Number v;
+	if (ind[i] != -1)
+	{
+		*v.num = buf[i];
+		v.ind = 0;
+	}
+	return v;
+}
+
+
+std::string
+Oracle::Number_Array::str(const int i) const throw(Oracle::Error)
+{
+	return get(i).str("");
+}
+
+
+long
+Oracle::Number_Array::lng(const int i) const throw(Oracle::Error)
+{
+	check(i, "Number_Array::lng(const int)");
+	if (ind[i] == -1)
+		throw Value_Error("Number_Array::lng(const int)", "Value is NULL");
+	long v;
+	if (OCINumberToInt(
+			env.thread_err(),					// error handle
+			&buf[i],						// OCINumber
+			(uword) sizeof(long),					// output integer size
+			OCI_NUMBER_SIGNED,					// signed/unsigned
+			(dvoid*) &v))						// output integer
+		throw OCI_Error("Number_Array::lng(const int)", env.thread_err());
+	return v;
+}
+
+
+double
+Oracle::Number_Array::dbl(const int i) const throw(Oracle::Error)
+{
+	check(i, "Number_Array::dbl(const int)");
+	if (ind[i] == -1)
+		throw Value_Error("Number_Array::dbl(const int)", "Value is NULL");
+	double v;
+	if (OCINumberToReal(
+			env.thread_err(),					// error handle
+			&buf[i],						// OCINumber
+			(uword) sizeof(double),					// output double size
+			(dvoid*) &v))						// output double
+		throw OCI_Error("Number_Array::dbl(const int)", env.thread_err());
+	return v;
+}
+
+
+int
+Oracle::Number_Array::sqlt() const throw()
+{
+	return SQLT_VNU;
+}
+
+
+int
+Oracle::Number_Array::width() const throw()
+{
+	return sizeof(OCINumber);
+}
+
+
+Oracle::Varchar_Array::Varchar_Array(const int sz, const int width) throw(Oracle::Error)
+	: Nullable_Array(sz), buf(0), w(width)
+{
+	if (w < 1)
+	{
+		Value_Error e("Varchar_Array::Varchar_Array(const int, const int)", "Width must be at least 1");
+		e.desc << "width = " << w;
+		throw e;
+	}
+	buf = new char[n * (w + 1)];
+	for (int i=0; i < n; i++)
+		buf[i * (w + 1)] = 0;
+}
+
+
+Oracle::Varchar_Array::~Varchar_Array() throw()
+{
+	delete [] buf;
+}
+
+
+void
+Oracle::Varchar_Array::set(const int i, const Str_View& v) throw(Oracle::Error)
+{
+	check(i, "Varchar_Array::set(const int, const Str_View&)");
+	if (v.size() > w)
+	{
+		Value_Error e("Varchar_Array::set(const int, const Str_View&)", "Value is too long");
+		e.desc << "length = " << v.size() << "; width = " << w;
+		throw e;
+	}
+	char* p = buf + i * (w + 1);
+	std::memcpy(p, v.data(), v.size());
+	p[v.size()] = 0;
+	ind[i] = 0;
+	len[i] = v.size() + 1;						// includes the terminator
+}
+
+
+void
+Oracle::Varchar_Array::set(const int i, const char* s) throw(Oracle::Error)
+{
+	set(i, Str_View(s, std::strlen(s)));
+}
+
+
+void
+Oracle::Varchar_Array::set(const int i, const std::string& s) throw(Oracle::Error)
+{
+	set(i, Str_View(s.data(), s.length()));
+}
+
+
+Oracle::Str_View
+Oracle::Varchar_Array::view(const int i) const throw(Oracle::Error)
+{
+	check(i, "Varchar_Array::view(const int)");
+	if (ind[i] == -1)
+		return Str_View();
+	const char* p = buf + i * (w + 1);
+	return Str_View(p, std::strlen(p));
+}
+
+
+std::string
+Oracle::Varchar_Array::str(const int i) const throw(Oracle::Error)
+{
+	return view(i).str();
+}
+
+
+int
+Oracle::Varchar_Array::sqlt() const throw()
+{
+	return SQLT_STR;
+}
+
+
+Oracle::Date_Array::Date_Array(const int sz) throw(Oracle::Error)
+	: Nullable_Array(sz), buf(new OCIDate[sz])
+{
+}
+
+
+Oracle::Date_Array::~Date_Array() throw()
+{
+	delete [] buf;
+}
+
+
+void
+Oracle::Date_Array::set(const int i, const Date& v) throw(Oracle::Error)
+{
+	check(i, "Date_Array::set(const int, const Date&)");
+	if (v.is_null())
+	{
+		ind[i] = -1;
+		return;
+	}
+	buf[i] = *v.date_;
+	ind[i] = 0;
+	len[i] = sizeof(OCIDate);
+}
+
+
+Oracle::Date
+Oracle::Date_Array::get(const int i) const throw(Oracle::Error)
+{
+	check(i, "Date_Array::get(const int)");
+	if (ind[i] == -1)
+		return Date();
+	return Date(buf[i]);
+}
+
+
+std::string
+Oracle::Date_Array::str(const int i) const throw(Oracle::Error)
+{
+	return get(i).str("");
+}
+
+
+int
+Oracle::Date_Array::sqlt() const throw()
+{
+	return SQLT_ODT;
+}
+
+
+int
+Oracle::Date_Array::width() const throw()
+{
+	return sizeof(OCIDate);
+}
@@ -0,0 +1,174 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Ora++ -- a C++ interface to Oracle based on the Oracle Call Interface
+// Copyright (C) 2000-1 James Edwin Cain <me@jimcain.net>
+// 
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or any
+// later version.
+// 
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef ORAPP_NULLABLE_ARRAY_H
+#define ORAPP_NULLABLE_ARRAY_H
+
+#include "Oracle.h"
+#include "Nullable.h"
+#include "Env.h"
+
+class OCINumber;
+class OCIDate;
+
+
+namespace Oracle
+{
+	class Number;
+	class Date;
+
+	// An array of values of one type, bound to a single placeholder with
+	// Stmt::bind() so that one execute sends many rows (see
+	// Non_Sel_Stmt::exec_batch()).  Values, null indicators and lengths are
+	// each one contiguous block that OCI reads directly.  Every element
+	// starts out NULL.
+	class Nullable_Array
+	{
+		public:
+			// constructors/destructor
+			virtual ~Nullable_Array()			throw();
+
+			// implementors
+			void set_null(const int)			throw(Error);	// make element NULL
+			void set_null()					throw();	// make all elements NULL
+
+			// accessors
+			int size() const				throw()		// number of elements
+				{ return n; }
+			bool is_null(const int) const			throw(Error);
+			virtual std::string str(const int) const	throw(Error) = 0; // "" if element is NULL
+			virtual int sqlt() const			throw() = 0;	// Oracle type
+			virtual int width() const			throw() = 0;	// bytes per element
+
+		protected:
+			// protected constructor
+			Nullable_Array(const int)			throw(Error);	// number of elements
+
+			// protected implementors
+			void check(const int, const char*) const	throw(Error);	// validate subscript
+			virtual void* data() const			throw() = 0;	// ptr to first value
+
+			// data members
+			int n;								// number of elements
+			sb2* ind;							// null indicators
+			ub2* len;							// value lengths
+
+		private:
+			// disallowed functions
+			Nullable_Array(const Nullable_Array&);
+			Nullable_Array& operator=(const Nullable_Array&);
+
+		friend class Stmt;
+		friend class Non_Sel_Stmt;
+		friend class Copy_Pipeline;
+	};
+
+
+	class Number_Array: public Nullable_Array
+	{
+		public:
+			// constructors/destructor
+			Number_Array(const int)				throw(Error);	// number of elements
+			virtual ~Number_Array()				throw();
+
+			// implementors
+			void set(const int, const long)			throw(Error);
+			void set(const int, const double)		throw(Error);
+			void set(const int, const Number&)		throw(Error);
+
+			// accessors
+			Number get(const int) const			throw(Error);	// NULL if element is NULL
+			virtual std::string str(const int) const	throw(Error);
+			long lng(const int) const			throw(Error);
+			double dbl(const int) const			throw(Error);
+			virtual int sqlt() const			throw();
+			virtual int width() const			throw();
+
+		protected:
+			// implementors
+			virtual void* data() const			throw()
+				{ return (void*)buf; }
+
+			// data members
+			OCINumber* buf;							// values
+			static Env env;							// initializes OCI environment
+	};
+
+
+	class Varchar_Array: public Nullable_Array
+	{
+		public:
+			// constructors/destructor
+			Varchar_Array(							// array of strings
+				const int,						// number of elements
+				const int)				throw(Error);	// max length of each
+			virtual ~Varchar_Array()			throw();
+
+			// implementors
+			void set(const int, const char*)		throw(Error);
+			void set(const int, const std::string&)		throw(Error);
+			void set(const int, const Str_View&)		throw(Error);
+
+			// accessors
+			Str_View view(const int) const			throw(Error);	// characters without copying
+			virtual std::string str(const int) const	throw(Error);
+			virtual int sqlt() const			throw();
+			virtual int width() const			throw()
+				{ return w + 1; }
+
+		protected:
+			// implementors
+			virtual void* data() const			throw()
+				{ return (void*)buf; }
+
+			// data members
+			char* buf;							// values, each w + 1 chars
+			int w;								// max length of each value
+	};
+
+
+	class Date_Array: public Nullable_Array
+	{
+		public:
+			// constructors/destructor
+			Date_Array(const int)				throw(Error);	// number of elements
+			virtual ~Date_Array()				throw();
+
+			// implementors
+			void set(const int, const Date&)		throw(Error);
+
+			// accessors
+			Date get(const int) const			throw(Error);	// NULL if element is NULL
+			virtual std::string str(const int) const	throw(Error);
+			virtual int sqlt() const			throw();
+			virtual int width() const			throw();
+
+		protected:
+			// implementors
+			virtual void* data() const			throw()
+				{ return (void*)buf; }
+
+			// data members
+			OCIDate* buf;							// values
+	};
+}
+
+#endif
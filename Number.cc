@@ -33,79 +33,89 @@ const std::string Oracle::Number::default_fmt = "TM";
 
 Oracle::Env Oracle::Number::env;
 
-Oracle::Number::Number() throw()
-	: Nullable(), num(new OCINumber)
+Oracle::Number::Number() throw(Oracle::Error)
+	: Nullable(), num(new OCINumber), ext(false)
 {
 	OCINumberSetZero(
-			env.err(),						// error handle
+			env.thread_err(),					// error handle
 			num);							// OCINumber
 }
 
 
 Oracle::Number::Number(const int n) throw(Oracle::Error)
-	: Nullable(), num(new OCINumber)
+	: Nullable(), num(new OCINumber), ext(false)
 {
 	if (OCINumberFromInt(
-			env.err(),						// error handle
+			env.thread_err(),					// error handle
 			(CONST dvoid*) &n,					// input integer
 			(uword) sizeof(int),					// input integer size
 			OCI_NUMBER_SIGNED,					// signed/unsigned
 			num))							// OCINumber
-		throw OCI_Error("Number::Number(const int)", env.err());
+		throw OCI_Error("Number::Number(const int)", env.thread_err());
 	ind = 0;
 }
 
 
 Oracle::Number::Number(const long n) throw(Oracle::Error)
-	: Nullable(), num(new OCINumber)
+	: Nullable(), num(new OCINumber), ext(false)
 {
 	if (OCINumberFromInt(
-			env.err(),						// error handle
+			env.thread_err(),					// error handle
 			(CONST dvoid*) &n,					// input integer
 			(uword) sizeof(long),					// input integer size
 			OCI_NUMBER_SIGNED,					// signed/unsigned
 			num))							// OCINumber
-		throw OCI_Error("Number::Number(const long)", env.err());
+		throw OCI_Error("Number::Number(const long)", env.thread_err());
 	ind = 0;
 }
 
 
 Oracle::Number::Number(const double n) throw(Oracle::Error)
-	: Nullable(), num(new OCINumber)
+	: Nullable(), num(new OCINumber), ext(false)
 {
 	if (OCINumberFromReal(
-			env.err(),						// error handle
+			env.thread_err(),					// error handle
 			(CONST dvoid*) &n,					// input integer
 			(uword) sizeof(double),					// input integer size
 			num))							// OCINumber
-		throw OCI_Error("Number::Number(const double)", env.err());
+		throw OCI_Error("Number::Number(const double)", env.thread_err());
 	ind = 0;
 }
 
 
 Oracle::Number::Number(const Oracle::Number& n) throw(Oracle::Error)
-	: Nullable(), num(new OCINumber)
+	: Nullable(), num(new OCINumber), ext(false)
 {
 	// if n is not null, initialize this Number with n's value;
 	// else initialize OCINumber to zero
 	if ((ind = n.ind) == 0)
 	{
 		if (OCINumberAssign(
-				env.err(),					// error handle
+				env.thread_err(),				// error handle
 				n.num,						// from OCINumber
 				num))						// to OCINumber
-			throw OCI_Error("Number::Number(const Number&)", env.err());
+			throw OCI_Error("Number::Number(const Number&)", env.thread_err());
 	}
 	else
 		OCINumberSetZero(
-				env.err(),					// error handle
+				env.thread_err(),				// error handle
 				num);						// OCINumber
 }
 
 
+Oracle::Number::Number(OCINumber* n) throw(Oracle::Error)
+	: Nullable(), num(n), ext(true)
+{
+	OCINumberSetZero(
+			env.thread_err(),					// error handle
+			num);							// OCINumber
+}
+
+
 Oracle::Number::~Number() throw()
 {
-	delete num;
+	if (!ext)
+		delete num;
 	ind = -1;
 }
 
@@ -132,7 +142,7 @@ Oracle::Number::str() const throw(Oracle::Error)
 	char buf[ORAPP_MAX_NUM_LEN];
 	ub4 buflen(ORAPP_MAX_NUM_LEN);
 	if (OCINumberToText(
-			env.err(),						// error handle
+			env.thread_err(),					// error handle
 			num,							// input OCINumber
 			(CONST text*) default_fmt.c_str(),			// format string
 			(ub4) default_fmt.length(),				// format string length
@@ -140,7 +150,7 @@ Oracle::Number::str() const throw(Oracle::Error)
 			(ub4) 0,						// NLS parameters length
 			&buflen,						// output buffer length			
 			(CONST text*) buf))					// output buffer
-		throw OCI_Error("Number::str()", env.err());
+		throw OCI_Error("Number::str()", env.thread_err());
 	return std::string(buf);
 }
 
@@ -153,7 +163,7 @@ Oracle::Number::str(const std::string& s) const throw(Oracle::Error)
 	char buf[ORAPP_MAX_NUM_LEN];
 	ub4 buflen(ORAPP_MAX_NUM_LEN);
 	if (OCINumberToText(
-			env.err(),						// error handle
+			env.thread_err(),					// error handle
 			num,							// input OCINumber
 			(CONST text*) default_fmt.c_str(),			// format string
 			(ub4) default_fmt.length(),				// format string length
@@ -161,7 +171,7 @@ Oracle::Number::str(const std::string& s) const throw(Oracle::Error)
 			(ub4) 0,						// NLS parameters length
 			&buflen,						// output buffer length			
 			(CONST text*) buf))					// output buffer
-		throw OCI_Error("Number::str(const std::string&)", env.err());
+		throw OCI_Error("Number::str(const std::string&)", env.thread_err());
 	return std::string(buf);
 }
 
@@ -174,7 +184,7 @@ Oracle::Number::str(const std::string& s, const std::string& f) const throw(Orac
 	char buf[ORAPP_MAX_NUM_LEN];
 	ub4 buflen(ORAPP_MAX_NUM_LEN);
 	if (OCINumberToText(
-			env.err(),						// error handle
+			env.thread_err(),					// error handle
 			num,							// input OCINumber
 			(CONST text*) f.c_str(),				// format string
 			(ub4) f.length(),					// format string length
@@ -182,7 +192,7 @@ Oracle::Number::str(const std::string& s, const std::string& f) const throw(Orac
 			(ub4) 0,						// NLS parameters length
 			&buflen,						// output buffer length			
 			(CONST text*) buf))					// output buffer
-		throw OCI_Error("Number::str(const std::string&, const std::string&)", env.err());
+		throw OCI_Error("Number::str(const std::string&, const std::string&)", env.thread_err());
 	return std::string(buf);
 }
 
@@ -203,12 +213,12 @@ Oracle::Number::lng() const throw(Oracle::Error)
 		return Nullable::lng();
 	long i;
 	if (OCINumberToInt(
-			env.err(),						// error handle
+			env.thread_err(),					// error handle
 			num,							// input OCINumber
 			(uword) sizeof(long),					// desired output size
 			(uword) OCI_NUMBER_SIGNED,				// signed/unsigned result
 			(dvoid*) &i))						// result
-		throw OCI_Error("Number::lng()", env.err());
+		throw OCI_Error("Number::lng()", env.thread_err());
 	return i;
 }
 
@@ -220,12 +230,12 @@ Oracle::Number::lng(const long n) const throw(Oracle::Error)
 		return n;
 	long i;
 	if (OCINumberToInt(
-			env.err(),						// error handle
+			env.thread_err(),					// error handle
 			num,							// input OCINumber
 			(uword) sizeof(long),					// desired output size
 			(uword) OCI_NUMBER_SIGNED,				// signed/unsigned result
 			(dvoid*) &i))						// result
-		throw OCI_Error("Number::lng(const long)", env.err());
+		throw OCI_Error("Number::lng(const long)", env.thread_err());
 	return i;
 }
 
@@ -237,11 +247,11 @@ Oracle::Number::dbl() const throw(Oracle::Error)
 		return Nullable::dbl();
 	double d;
 	if (OCINumberToReal(
-			env.err(),						// error handle
+			env.thread_err(),					// error handle
 			num,							// input OCINumber
 			(uword) sizeof(double),					// desired output size
 			(dvoid*) &d))						// result
-		throw OCI_Error("Number::dbl()", env.err());
+		throw OCI_Error("Number::dbl()", env.thread_err());
 	return d;
 }
 
@@ -253,11 +263,11 @@ Oracle::Number::dbl(const double n) const throw(Oracle::Error)
 		return n;
 	double d;
 	if (OCINumberToReal(
-			env.err(),						// error handle
+			env.thread_err(),					// error handle
 			num,							// input OCINumber
 			(uword) sizeof(double),					// desired output size
 			(dvoid*) &d))						// result
-		throw OCI_Error("Number::dbl(const double)", env.err());
+		throw OCI_Error("Number::dbl(const double)", env.thread_err());
 	return d;
 }
 
@@ -269,10 +279,10 @@ Oracle::Number::abs() const throw(Oracle::Error)
 	if (ind == 0)
 	{
 		if (OCINumberAbs(
-				env.err(),					// error handle
+				env.thread_err(),				// error handle
 				num,						// input OCINumber
 				n.num))						// output OCINumber
-			throw OCI_Error("Number::abs()", env.err());
+			throw OCI_Error("Number::abs()", env.thread_err());
 		n.ind = 0;
 	}
 	return n;
@@ -286,10 +296,10 @@ Oracle::Number::ceil() const throw(Oracle::Error)
 	if (ind == 0)
 	{
 		if (OCINumberCeil(
-				env.err(),					// error handle
+				env.thread_err(),				// error handle
 				num,						// input OCINumber
 				n.num))						// output OCINumber
-			throw OCI_Error("Number::ceil()", env.err());
+			throw OCI_Error("Number::ceil()", env.thread_err());
 		n.ind = 0;
 	}
 	return n;
@@ -303,10 +313,10 @@ Oracle::Number::floor() const throw(Oracle::Error)
 	if (ind == 0)
 	{
 		if (OCINumberFloor(
-				env.err(),					// error handle
+				env.thread_err(),				// error handle
 				num,						// input OCINumber
 				n.num))						// output OCINumber
-			throw OCI_Error("Number::floor()", env.err());
+			throw OCI_Error("Number::floor()", env.thread_err());
 		n.ind = 0;
 	}
 	return n;
@@ -320,11 +330,11 @@ Oracle::Number::round(const int i) const throw(Oracle::Error)
 	if (ind == 0)
 	{
 		if (OCINumberRound(
-				env.err(),					// error handle
+				env.thread_err(),				// error handle
 				num,						// input OCINumber
 				(sword) i,					// #decimal places
 				n.num))						// output OCINumber
-			throw OCI_Error("Number::round(const int)", env.err());
+			throw OCI_Error("Number::round(const int)", env.thread_err());
 		n.ind = 0;
 	}
 	return n;
@@ -338,11 +348,11 @@ Oracle::Number::mod(const Oracle::Number& m) const throw(Oracle::Error)
 	if (ind == 0 && m.ind == 0)
 	{
 		if (OCINumberMod(
-				env.err(),					// error handle
+				env.thread_err(),				// error handle
 				num,						// base OCINumber
 				m.num,						// exponent OCINumber
 				n.num))						// output OCINumber
-			throw OCI_Error("Number::mod(const Number&)", env.err());
+			throw OCI_Error("Number::mod(const Number&)", env.thread_err());
 		n.ind = 0;
 	}
 	return n;
@@ -356,11 +366,11 @@ Oracle::Number::pow(const Oracle::Number& p) const throw(Oracle::Error)
 	if (ind == 0 && p.ind == 0)
 	{
 		if (OCINumberPower(
-				env.err(),					// error handle
+				env.thread_err(),				// error handle
 				num,						// base OCINumber
 				p.num,						// exponent OCINumber
 				n.num))						// output OCINumber
-			throw OCI_Error("Number::power(const Number&)", env.err());
+			throw OCI_Error("Number::power(const Number&)", env.thread_err());
 		n.ind = 0;
 	}
 	return n;
@@ -374,11 +384,11 @@ Oracle::Number::pow(const int p) const throw(Oracle::Error)
 	if (ind == 0)
 	{
 		if (OCINumberIntPower(
-				env.err(),					// error handle
+				env.thread_err(),				// error handle
 				num,						// base OCINumber
 				(CONST sword)p,					// exponent
 				n.num))						// output OCINumber
-			throw OCI_Error("Number::power(const int)", env.err());
+			throw OCI_Error("Number::power(const int)", env.thread_err());
 		n.ind = 0;
 	}
 	return n;
@@ -392,10 +402,10 @@ Oracle::Number::sqrt() const throw(Oracle::Error)
 	if (ind == 0)
 	{
 		if (OCINumberSqrt(
-				env.err(),					// error handle
+				env.thread_err(),				// error handle
 				num,						// input OCINumber
 				n.num))						// output OCINumber
-			throw OCI_Error("Number::sqrt()", env.err());
+			throw OCI_Error("Number::sqrt()", env.thread_err());
 		n.ind = 0;
 	}
 	return n;
@@ -409,11 +419,11 @@ Oracle::Number::trunc(const int i) const throw(Oracle::Error)
 	if (ind == 0)
 	{
 		if (OCINumberTrunc(
-				env.err(),					// error handle
+				env.thread_err(),				// error handle
 				num,						// input OCINumber
 				(sword) i,					// #decimal places
 				n.num))						// output OCINumber
-			throw OCI_Error("Number::trunc()", env.err());
+			throw OCI_Error("Number::trunc()", env.thread_err());
 		n.ind = 0;
 	}
 	return n;
@@ -424,12 +434,12 @@ Oracle::Number&
 Oracle::Number::operator=(const int rhs) throw(Oracle::Error)
 {
 	if (OCINumberFromInt(
-			env.err(),						// error handle
+			env.thread_err(),					// error handle
 			(CONST dvoid*) &rhs,					// input integer
 			(uword) sizeof(int),					// input integer size
 			OCI_NUMBER_SIGNED,					// signed/unsigned
 			num))							// OCINumber
-		throw OCI_Error("Number::operator=(const int)", env.err());
+		throw OCI_Error("Number::operator=(const int)", env.thread_err());
 	ind = 0;
 	return *this;
 }
@@ -439,12 +449,12 @@ Oracle::Number&
 Oracle::Number::operator=(const long rhs) throw(Oracle::Error)
 {
 	if (OCINumberFromInt(
-			env.err(),						// error handle
+			env.thread_err(),					// error handle
 			(CONST dvoid*) &rhs,					// input integer
 			(uword) sizeof(long),					// input integer size
 			OCI_NUMBER_SIGNED,					// signed/unsigned
 			num))							// OCINumber
-		throw OCI_Error("Number::operator=(const long)", env.err());
+		throw OCI_Error("Number::operator=(const long)", env.thread_err());
 	ind = 0;
 	return *this;
 }
@@ -454,11 +464,11 @@ Oracle::Number&
 Oracle::Number::operator=(const double rhs) throw(Oracle::Error)
 {
 	if (OCINumberFromReal(
-			env.err(),						// error handle
+			env.thread_err(),					// error handle
 			(CONST dvoid*) &rhs,					// input integer
 			(uword) sizeof(double),					// input integer size
 			num))							// OCINumber
-		throw OCI_Error("Number::operator=(const double)", env.err());
+		throw OCI_Error("Number::operator=(const double)", env.thread_err());
 	ind = 0;
 	return *this;
 }
@@ -470,10 +480,10 @@ Oracle::Number::operator=(const Oracle::Number& rhs) throw(Oracle::Error)
 	if (&rhs != this)
 		if ((ind = rhs.ind) == 0)
 			if (OCINumberAssign(
-					env.err(),				// error handle
+					env.thread_err(),			// error handle
 					rhs.num,				// from OCINumber
 					num))					// to OCINumber
-				throw OCI_Error("Number::operator=(const Number&)", env.err());
+				throw OCI_Error("Number::operator=(const Number&)", env.thread_err());
 	return *this;
 }
 
@@ -483,11 +493,11 @@ Oracle::Number::operator+=(const Oracle::Number& n) throw(Oracle::Error)
 {
 	if (ind == 0 && (ind = n.ind) == 0)
 		if (OCINumberAdd(
-				env.err(),					// error handle
+				env.thread_err(),				// error handle
 				num,						// first OCINumber
 				n.num,						// second OCINumber
 				num))						// sum
-			throw OCI_Error("Number::operator+=(const Number&)", env.err());
+			throw OCI_Error("Number::operator+=(const Number&)", env.thread_err());
 	return *this;
 }
 
@@ -497,11 +507,11 @@ Oracle::Number::operator-=(const Oracle::Number& n) throw(Oracle::Error)
 {
 	if (ind == 0 && (ind = n.ind) == 0)
 		if (OCINumberSub(
-				env.err(),					// error handle
+				env.thread_err(),				// error handle
 				num,						// first OCINumber
 				n.num,						// second OCINumber
 				num))						// first - second
-			throw OCI_Error("Number::operator-=(const Number&)", env.err());
+			throw OCI_Error("Number::operator-=(const Number&)", env.thread_err());
 	return *this;
 }
 
@@ -511,11 +521,11 @@ Oracle::Number::operator*=(const Oracle::Number& n) throw(Oracle::Error)
 {
 	if (ind == 0 && (ind = n.ind) == 0)
 		if (OCINumberMul(
-				env.err(),					// error handle
+				env.thread_err(),				// error handle
 				num,						// first OCINumber
 				n.num,						// second OCINumber
 				num))						// product
-			throw OCI_Error("Number::operator*=(const Number&)", env.err());
+			throw OCI_Error("Number::operator*=(const Number&)", env.thread_err());
 	return *this;
 }
 
@@ -525,11 +535,11 @@ Oracle::Number::operator/=(const Oracle::Number& n) throw(Oracle::Error)
 {
 	if (ind == 0 && (ind = n.ind) == 0)
 		if (OCINumberDiv(
-				env.err(),					// error handle
+				env.thread_err(),				// error handle
 				num,						// first OCINumber
 				n.num,						// second OCINumber
 				num))						// first / second
-			throw OCI_Error("Number::operator/=(const Number&)", env.err());
+			throw OCI_Error("Number::operator/=(const Number&)", env.thread_err());
 	return *this;
 }
 
@@ -545,11 +555,11 @@ Oracle::Number::operator==(const Oracle::Number& n) throw(Oracle::Error)
 	{
 		sword result;
 		if (OCINumberCmp(
-				env.err(),				// error handle
+				env.thread_err(),			// error handle
 				num,					// first OCINumber
 				n.num,					// second OCINumber
 				&result))				// -1, 0 or 1
-			throw OCI_Error("Number::operator==(const Number&)", env.err());
+			throw OCI_Error("Number::operator==(const Number&)", env.thread_err());
 		return result == 0;
 	}
 }
@@ -566,11 +576,11 @@ Oracle::Number::operator!=(const Oracle::Number& n) throw(Oracle::Error)
 	{
 		sword result;
 		if (OCINumberCmp(
-				env.err(),				// error handle
+				env.thread_err(),			// error handle
 				num,					// first OCINumber
 				n.num,					// second OCINumber
 				&result))				// -1, 0 or 1
-			throw OCI_Error("Number::operator!=(const Number&)", env.err());
+			throw OCI_Error("Number::operator!=(const Number&)", env.thread_err());
 		return result != 0;
 	}
 }
@@ -587,11 +597,11 @@ Oracle::Number::operator<(const Oracle::Number& n) throw(Oracle::Error)
 	{
 		sword result;
 		if (OCINumberCmp(
-				env.err(),				// error handle
+				env.thread_err(),			// error handle
 				num,					// first OCINumber
 				n.num,					// second OCINumber
 				&result))				// -1, 0 or 1
-			throw OCI_Error("Number::operator<(const Number&)", env.err());
+			throw OCI_Error("Number::operator<(const Number&)", env.thread_err());
 		return result < 0;
 	}
 }
@@ -608,11 +618,11 @@ Oracle::Number::operator<=(const Oracle::Number& n) throw(Oracle::Error)
 	{
 		sword result;
 		if (OCINumberCmp(
-				env.err(),				// error handle
+				env.thread_err(),			// error handle
 				num,					// first OCINumber
 				n.num,					// second OCINumber
 				&result))				// -1, 0 or 1
-			throw OCI_Error("Number::operator==(const Number&)", env.err());
+			throw OCI_Error("Number::operator==(const Number&)", env.thread_err());
 		return result <= 0;
 	}
 }
@@ -629,11 +639,11 @@ Oracle::Number::operator>(const Oracle::Number& n) throw(Oracle::Error)
 	{
 		sword result;
 		if (OCINumberCmp(
-				env.err(),				// error handle
+				env.thread_err(),			// error handle
 				num,					// first OCINumber
 				n.num,					// second OCINumber
 				&result))				// -1, 0 or 1
-			throw OCI_Error("Number::operator>(const Number&)", env.err());
+			throw OCI_Error("Number::operator>(const Number&)", env.thread_err());
 		return result > 0;
 	}
 }
@@ -650,11 +660,11 @@ Oracle::Number::operator>=(const Oracle::Number& n) throw(Oracle::Error)
 	{
 		sword result;
 		if (OCINumberCmp(
-				env.err(),				// error handle
+				env.thread_err(),			// error handle
 				num,					// first OCINumber
 				n.num,					// second OCINumber
 				&result))				// -1, 0 or 1
-			throw OCI_Error("Number::operator>=(const Number&)", env.err());
+			throw OCI_Error("Number::operator>=(const Number&)", env.thread_err());
 		return result >= 0;
 	}
 }
@@ -33,7 +33,7 @@ namespace Oracle
 	{
 		public:
 			// constructors/destructor
-			Number()						throw();
+			Number()						throw(Error);
 			Number(const int)					throw(Error);
 			Number(const long)					throw(Error);
 			Number(const double)					throw(Error);
@@ -80,13 +80,20 @@ namespace Oracle
 			bool operator>=(const Number&)				throw(Error);
 
 		protected:
+			// constructor
+			Number(OCINumber*)					throw(Error);	// use given storage
+
 			// data members
 			OCINumber* num;								// value
+			bool ext;								// num is not owned
 			static Env env;								// initializes OCI environment
 			const static std::string default_fmt;					// default conversion format to/from text
 			
 			// implementors
 			virtual void* data() const { return (void*)num; }			// ptr to data
+
+		friend class Rowtype;
+		friend class Number_Array;
 	};
 
 	inline std::ostream& operator<<(std::ostream& o, const Number& n)
@@ -28,9 +28,19 @@
 #include "Varchar.h"
 #include "Number.h"
 #include "Date.h"
+#include "Nullable_Array.h"
 #include "Stmt.h"
 #include "Select_Stmt.h"
 #include "Cursor.h"
 #include "Non_Sel_Stmt.h"
+#include "Direct_Load.h"
+#include "Name_Index.h"
 #include "Rowtype.h"
+#include "Column_Batch.h"
+#include "Field.h"
+#include "Parallel_Select.h"
+#include "Copy_Pipeline.h"
+#include "Connection_Pool.h"
+#include "Reactor.h"
+#include "Bulk_Open.h"
 #endif
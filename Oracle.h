@@ -49,6 +49,12 @@ namespace Oracle
 			const int = 0);				// line number
 		Error(const Error&);
 
+		// implementors
+		virtual Error* clone() const			// copy of the same type (e.g. to pass between threads)
+			{ return new Error(*this); }
+		virtual void raise() const			// throw a copy of the same type
+			{ throw *this; }
+
 		// accessors
 		std::string str() const;			// get formatted error message
 		const char* what() const
@@ -70,6 +76,10 @@ namespace Oracle
 			const std::string&,			// error message
 			const std::string& = "",		// file name
 			const int = 0);				// line number
+		virtual Error* clone() const
+			{ return new State_Error(*this); }
+		virtual void raise() const
+			{ throw *this; }
 	};
 
 
@@ -80,6 +90,10 @@ namespace Oracle
 			const std::string&,			// error message
 			const std::string& = "",		// file name
 			const int = 0);				// line number
+		virtual Error* clone() const
+			{ return new Value_Error(*this); }
+		virtual void raise() const
+			{ throw *this; }
 	};
 
 
@@ -90,6 +104,10 @@ namespace Oracle
 			const std::string&,			// error message
 			const std::string& = "",		// file name
 			const int = 0);				// line number
+		virtual Error* clone() const
+			{ return new Type_Error(*this); }
+		virtual void raise() const
+			{ throw *this; }
 	};
 
 
@@ -101,6 +119,10 @@ namespace Oracle
 			const std::string& = "",		// file name
 			const int = 0);				// line number
 		OCI_Error(const OCI_Error&);
+		virtual Error* clone() const
+			{ return new OCI_Error(*this); }
+		virtual void raise() const
+			{ throw *this; }
 		int ora_code;
 	};
 
@@ -0,0 +1,758 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Ora++ -- a C++ interface to Oracle based on the Oracle Call Interface
+// Copyright (C) 2000-1 James Edwin Cain <me@jimcain.net>
+// 
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or any
+// later version.
+// 
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Oracle.h"
+#include "Parallel_Select.h"
+#include "Connection.h"
+#include "Select_Stmt.h"
+#include "Rowtype.h"
+#include "Varchar.h"
+#include "Env.h"
+#include <sstream>
+#include <iomanip>
+#include <cstring>
+#include <oci.h>
+
+
+namespace
+{
+	struct Extent							// one extent of the split table
+	{
+		long obj;						// data object id
+		long fno;						// relative file number
+		long block;						// first block
+		long blocks;						// number of blocks
+	};
+}
+
+
+Oracle::Parallel_Select::Parallel_Select(const std::vector<Connection*>& conns, const std::string& s) throw(Oracle::Error)
+	: sql(s), split(None), lo(0), hi(0), less(0), arr_sz(100), depth(3), running(false), stopping(false),
+	  cur(-1), rr(0), total_rows(0), t0(0), t1(0)
+{
+	if (conns.empty())
+		throw Value_Error("Parallel_Select::Parallel_Select(const std::vector<Connection*>&, const std::string&)", "At least one Connection is required");
+
+	parts.resize(conns.size());
+	pstats.resize(conns.size());
+	for (int i=0; i < parts.size(); i++)
+	{
+		Part& p = parts[i];
+		p.owner = this;
+		p.id = i;
+		p.conn = conns[i];
+		p.stmt = 0;
+		p.row = 0;
+		p.head = p.tail = p.count = p.pos = 0;
+		p.loaded = false;
+		p.done = true;
+		p.started = false;
+		p.err = 0;
+	}
+
+	pthread_mutex_init(&mtx, 0);
+	pthread_cond_init(&ready_cv, 0);
+	pthread_cond_init(&taken_cv, 0);
+}
+
+
+Oracle::Parallel_Select::~Parallel_Select() throw()
+{
+	close();
+	pthread_cond_destroy(&taken_cv);
+	pthread_cond_destroy(&ready_cv);
+	pthread_mutex_destroy(&mtx);
+}
+
+
+void
+Oracle::Parallel_Select::check_idle(const std::string& module) const throw(Oracle::Error)
+{
+	if (running)
+	{
+		State_Error e(module, "Query is already running");
+		e.desc << "statement = {" << sql << "}";
+		throw e;
+	}
+}
+
+
+void
+Oracle::Parallel_Select::split_range(const std::string& expr, const double l, const double h) throw(Oracle::Error)
+{
+	check_idle("Parallel_Select::split_range(const std::string&, const double, const double)");
+	if (h <= l)
+	{
+		Value_Error e("Parallel_Select::split_range(const std::string&, const double, const double)",
+			"High bound must be greater than low bound");
+		e.desc << "low = " << l << ", high = " << h;
+		throw e;
+	}
+	split = Range;
+	split_expr = expr;
+	lo = l;
+	hi = h;
+}
+
+
+void
+Oracle::Parallel_Select::split_rowid(const std::string& table, const std::string& own) throw(Oracle::Error)
+{
+	check_idle("Parallel_Select::split_rowid(const std::string&, const std::string&)");
+	if (sql.find(":lo") == std::string::npos || sql.find(":hi") == std::string::npos)
+	{
+		Value_Error e("Parallel_Select::split_rowid(const std::string&, const std::string&)",
+			"Query must contain the placeholders :lo and :hi");
+		e.desc << "statement = {" << sql << "}";
+		throw e;
+	}
+	split = Rowid;
+	split_expr = table;
+	owner = own;
+}
+
+
+void
+Oracle::Parallel_Select::set_order(const std::string& ob, less_fn f) throw(Oracle::Error)
+{
+	check_idle("Parallel_Select::set_order(const std::string&, less_fn)");
+	order_by = ob;
+	less = f;
+}
+
+
+void
+Oracle::Parallel_Select::set_array_size(const int n) throw(Oracle::Error)
+{
+	check_idle("Parallel_Select::set_array_size(const int)");
+	if (n < 1)
+	{
+		Value_Error e("Parallel_Select::set_array_size(const int)", "Array size must be at least 1");
+		e.desc << "size = " << n;
+		throw e;
+	}
+	arr_sz = n;
+}
+
+
+void
+Oracle::Parallel_Select::set_queue_depth(const int n) throw(Oracle::Error)
+{
+	check_idle("Parallel_Select::set_queue_depth(const int)");
+	if (n < 1)
+	{
+		Value_Error e("Parallel_Select::set_queue_depth(const int)", "Queue depth must be at least 1");
+		e.desc << "depth = " << n;
+		throw e;
+	}
+	depth = n;
+}
+
+
+std::string
+Oracle::Parallel_Select::part_sql(const int i) const throw(Oracle::Error)
+{
+	if (i < 0 || i >= parts.size())
+	{
+		Value_Error e("Parallel_Select::part_sql(const int)", "Partition out of range");
+		e.desc << "partition = " << i;
+		throw e;
+	}
+
+	// a ROWID split binds :lo and :hi in the query itself
+	const int n = parts.size();
+	std::ostringstream s;
+	if (split != Range || n == 1)
+		s << sql;
+	else
+	{
+		// every row must fall in exactly one partition, so NULLs go to the first
+		const double w = (hi - lo) / n;
+		s << std::setprecision(17) << "SELECT * FROM (" << sql << ") WHERE (";
+		if (i > 0)
+			s << split_expr << " >= " << lo + i * w;
+		if (i > 0 && i < n - 1)
+			s << " AND ";
+		if (i < n - 1)
+			s << split_expr << " < " << lo + (i + 1) * w;
+		if (i == 0)
+			s << " OR " << split_expr << " IS NULL";
+		s << ")";
+	}
+
+	if (!order_by.empty())
+		s << " ORDER BY " << order_by;
+
+	return s.str();
+}
+
+
+void
+Oracle::Parallel_Select::plan_rowid() throw(Oracle::Error)
+{
+	// Read the table's extents in ROWID order (data object, relative file,
+	// block) and give each partition an equal number of blocks.  A range
+	// from the first block of its share to the last covers exactly those
+	// blocks of the table, so the partitions are disjoint and complete.
+	const bool dba = !owner.empty();
+	std::ostringstream q;
+	q << "SELECT o.data_object_id, e.relative_fno, e.block_id, e.blocks"
+		<< " FROM " << (dba ? "dba" : "user") << "_extents e, "
+		<< (dba ? "dba" : "user") << "_objects o"
+		<< " WHERE e.segment_name = '" << sqlquote(split_expr) << "'"
+		<< " AND o.object_name = e.segment_name"
+		<< " AND o.object_type LIKE 'TABLE%'"
+		<< " AND NVL(o.subobject_name, ' ') = NVL(e.partition_name, ' ')";
+	if (dba)
+		q << " AND e.owner = '" << sqlquote(owner) << "' AND o.owner = e.owner";
+	q << " ORDER BY 1, 2, 3";
+
+	std::vector<Extent> ext_v;
+	long total = 0;
+	{
+		Select_Stmt st(*parts[0].conn, q.str());
+		while (st.fetch())
+		{
+			Extent x;
+			x.obj = st[0].lng();
+			x.fno = st[1].lng();
+			x.block = st[2].lng();
+			x.blocks = st[3].lng();
+			ext_v.push_back(x);
+			total += x.blocks;
+		}
+	}
+	if (!total)
+	{
+		Value_Error e("Parallel_Select::exec()", "No extents found for the split table");
+		e.desc << "table = " << (dba ? owner + "." : "") << split_expr;
+		throw e;
+	}
+
+	// partition i gets blocks [i*total/n, (i+1)*total/n) of the extent list
+	const int n = parts.size();
+	int k = 0;
+	long before = 0;						// blocks in extents before k
+	for (int i=0; i < n; i++)
+	{
+		long first = total * i / n;
+		long last = total * (i + 1) / n - 1;
+		if (last < first)
+			continue;					// fewer blocks than partitions
+
+		while (before + ext_v[k].blocks <= first)
+			before += ext_v[k++].blocks;
+		const Extent& a = ext_v[k];
+		long a_blk = a.block + (first - before);
+
+		int j = k;
+		long before_j = before;
+		while (before_j + ext_v[j].blocks <= last)
+			before_j += ext_v[j++].blocks;
+		const Extent& b = ext_v[j];
+		long b_blk = b.block + (last - before_j);
+
+		std::ostringstream r;
+		r << "SELECT DBMS_ROWID.ROWID_CREATE(1, " << a.obj << ", " << a.fno << ", " << a_blk << ", 0),"
+			<< " DBMS_ROWID.ROWID_CREATE(1, " << b.obj << ", " << b.fno << ", " << b_blk << ", 32767)"
+			<< " FROM dual";
+		Select_Stmt st(*parts[0].conn, r.str());
+		if (st.fetch())
+		{
+			pstats[i].lo = st[0].str();
+			pstats[i].hi = st[1].str();
+		}
+	}
+}
+
+
+void
+Oracle::Parallel_Select::exec() throw(Oracle::Error)
+{
+	check_idle("Parallel_Select::exec()");
+	if (parts.size() > 1 && split == None)
+	{
+		State_Error e("Parallel_Select::exec()", "No split has been set");
+		e.desc << "statement = {" << sql << "}";
+		throw e;
+	}
+	if (parts.size() > 1 && !Env::threaded())
+		throw State_Error("Parallel_Select::exec()", "The Oracle environment is not in threaded mode");
+
+	for (int i=0; i < parts.size(); i++)
+	{
+		pstats[i].sql = part_sql(i);
+		pstats[i].lo = pstats[i].hi = "";
+		pstats[i].rows = pstats[i].blocks = 0;
+		pstats[i].exec_secs = pstats[i].wait_secs = pstats[i].secs = pstats[i].rows_per_sec = 0;
+	}
+	if (split == Rowid)
+		plan_rowid();
+
+	running = true;
+	cur = -1;
+	rr = 0;
+	total_rows = 0;
+	t0 = Env::now();
+	t1 = 0;
+	for (int i=0; i < parts.size(); i++)
+	{
+		Part& p = parts[i];
+		p.head = p.tail = p.count = p.pos = 0;
+		p.loaded = false;
+		p.done = false;
+	}
+
+	for (int i=0; i < parts.size(); i++)
+	{
+		if (pthread_create(&parts[i].thr, 0, thread_main, &parts[i]))
+		{
+			for (int j=i; j < parts.size(); j++)
+				parts[j].done = true;
+			close();
+			Error e("Parallel_Select::exec()", "Cannot create worker thread");
+			e.desc << "partition = " << i;
+			throw e;
+		}
+		parts[i].started = true;
+	}
+}
+
+
+void*
+Oracle::Parallel_Select::thread_main(void* arg)
+{
+	Part* p = (Part*) arg;
+	p->owner->run(*p);
+	return 0;
+}
+
+
+void
+Oracle::Parallel_Select::init_blocks(Part& p) throw(Oracle::Error)
+{
+	// describe the columns; the reader loads each row into this Rowtype
+	p.row = new Rowtype(*p.stmt);
+	p.q.resize(depth);
+	for (int k=0; k < depth; k++)
+	{
+		Block& b = p.q[k];
+		b.rows = 0;
+		for (int i=0; i < p.row->ncols(); i++)
+		{
+			Col_Array a;
+			a.buf = new char[arr_sz * (*p.row)[i].maxsize()];
+			a.ind = new sb2[arr_sz];
+			a.len = new ub2[arr_sz];
+			b.cols.push_back(a);
+		}
+	}
+}
+
+
+void
+Oracle::Parallel_Select::free_blocks(Part& p) throw()
+{
+	for (int k=0; k < p.q.size(); k++)
+		for (int i=0; i < p.q[k].cols.size(); i++)
+		{
+			delete [] p.q[k].cols[i].buf;
+			delete [] p.q[k].cols[i].ind;
+			delete [] p.q[k].cols[i].len;
+		}
+	p.q.clear();
+	delete p.row;
+	p.row = 0;
+}
+
+
+void
+Oracle::Parallel_Select::define_block(Part& p, Block& b) throw(Oracle::Error)
+{
+	// defining a position again replaces the earlier define
+	Select_Stmt& s = *p.stmt;
+	for (int i=0; i < b.cols.size(); i++)
+	{
+		Nullable& c = (*p.row)[i];
+		Col_Array& a = b.cols[i];
+		OCIDefine* def_h = 0;
+		if (OCIDefineByPos(
+				s.stmt_h,					// stmt handle
+				&def_h,						// define handle returned
+				s.err_h,					// error handle
+				(ub4) i + 1,					// position (one-based)
+				(dvoid*) a.buf,					// output buffer
+				(sb4) c.maxsize(),				// size of one value
+				(ub2) c.sqlt(),					// external data type
+				(dvoid*) a.ind,					// indicators
+				a.len,						// returned lengths
+				(ub2*) 0,					// array of return codes
+				(ub4) OCI_DEFAULT)
+			|| OCIDefineArrayOfStruct(
+				def_h,						// define handle
+				s.err_h,					// error handle
+				(ub4) c.maxsize(),				// skip between values
+				(ub4) sizeof(sb2),				// skip between indicators
+				(ub4) sizeof(ub2),				// skip between lengths
+				(ub4) 0))					// skip between return codes
+		{
+			OCI_Error e("Parallel_Select::run()", s.err_h);
+			e.desc << "statement = {" << s.str() << "}; position = " << i + 1;
+			throw e;
+		}
+	}
+}
+
+
+void
+Oracle::Parallel_Select::run(Part& p) throw()
+{
+	Part_Stats& ps = pstats[p.id];
+	try
+	{
+		Select_Stmt* stmt = new Select_Stmt(*p.conn, ps.sql);
+		pthread_mutex_lock(&mtx);
+		p.stmt = stmt;
+		pthread_mutex_unlock(&mtx);
+
+		// an empty string binds as NULL, which selects nothing
+		Varchar lo_v(ps.lo), hi_v(ps.hi);
+		if (split == Rowid)
+		{
+			stmt->bind(lo_v, ":lo");
+			stmt->bind(hi_v, ":hi");
+		}
+		stmt->exec();
+		double t = Env::now() - t0;
+		pthread_mutex_lock(&mtx);
+		ps.exec_secs = t;
+		pthread_mutex_unlock(&mtx);
+
+		init_blocks(p);
+		ub4 prev = 0;
+		for (;;)
+		{
+			// wait for a free block
+			t = Env::now();
+			pthread_mutex_lock(&mtx);
+			while (p.count == depth && !stopping)
+				pthread_cond_wait(&taken_cv, &mtx);
+			bool stop = stopping;
+			ps.wait_secs += Env::now() - t;
+			pthread_mutex_unlock(&mtx);
+			if (stop)
+				break;
+
+			Block& b = p.q[p.tail];
+			define_block(p, b);
+			sword rc;
+			do
+				rc = OCIStmtFetch(
+					stmt->stmt_h,				// stmt handle
+					stmt->err_h,				// error handle
+					(ub4) arr_sz,				// #rows to fetch
+					(ub4) OCI_FETCH_NEXT,			// orientation
+					(ub4) OCI_DEFAULT);			// mode
+			while (rc == OCI_STILL_EXECUTING);
+			if (rc != OCI_SUCCESS && rc != OCI_SUCCESS_WITH_INFO && rc != OCI_NO_DATA)
+			{
+				OCI_Error e("Parallel_Select::run()", stmt->err_h);
+				e.desc << "statement = {" << ps.sql << "}";
+				throw e;
+			}
+
+			// the row count is cumulative
+			ub4 count;
+			if (OCIAttrGet(	(dvoid *) stmt->stmt_h,			// statement handle
+					(ub4) OCI_HTYPE_STMT,			// handle type
+					(dvoid *) &count,			// returned value
+					(ub4 *) 0,				// output size (0==default)
+					(ub4) OCI_ATTR_ROW_COUNT,		// attribute to return
+					stmt->err_h))				// error handle
+				throw OCI_Error("Parallel_Select::run()", stmt->err_h);
+			int rows = count - prev;
+			prev = count;
+
+			pthread_mutex_lock(&mtx);
+			b.rows = rows;
+			if (rows > 0)
+			{
+				p.tail = (p.tail + 1) % depth;
+				p.count++;
+				ps.rows += rows;
+				ps.blocks++;
+			}
+			if (rc == OCI_NO_DATA)
+				p.done = true;
+			pthread_cond_broadcast(&ready_cv);
+			pthread_mutex_unlock(&mtx);
+			if (rc == OCI_NO_DATA)
+				break;
+		}
+	}
+	catch (Error& e)
+	{
+		pthread_mutex_lock(&mtx);
+		p.err = e.clone();
+		pthread_mutex_unlock(&mtx);
+	}
+	catch (...)
+	{
+		pthread_mutex_lock(&mtx);
+		p.err = new Error("Parallel_Select::run()", "Unexpected exception in worker thread");
+		p.err->desc << "partition = " << p.id;
+		pthread_mutex_unlock(&mtx);
+	}
+
+	pthread_mutex_lock(&mtx);
+	ps.secs = Env::now() - t0;
+	ps.rows_per_sec = ps.secs > 0 ? ps.rows / ps.secs : 0;
+	p.done = true;
+	pthread_cond_broadcast(&ready_cv);
+	pthread_mutex_unlock(&mtx);
+}
+
+
+bool
+Oracle::Parallel_Select::fetch() throw(Oracle::Error)
+{
+	// start the workers if not already done
+	if (!running)
+		exec();
+
+	advance();
+	int i = less ? next_ordered() : next_ready();
+	if (i < 0)
+	{
+		if (!t1)
+			t1 = Env::now();
+		return false;
+	}
+
+	cur = i;
+	total_rows++;
+	return true;
+}
+
+
+void
+Oracle::Parallel_Select::advance() throw()
+{
+	// a block is given back to its worker once all its rows are read
+	if (cur < 0)
+		return;
+	Part& p = parts[cur];
+	pthread_mutex_lock(&mtx);
+	p.loaded = false;
+	if (++p.pos >= p.q[p.head].rows)
+	{
+		p.head = (p.head + 1) % depth;
+		p.count--;
+		p.pos = 0;
+		pthread_cond_broadcast(&taken_cv);
+	}
+	pthread_mutex_unlock(&mtx);
+	cur = -1;
+}
+
+
+void
+Oracle::Parallel_Select::load(Part& p) throw()
+{
+	// the head block is not written by the worker while it is queued
+	const Block& b = p.q[p.head];
+	const int r = p.pos;
+	for (int i=0; i < b.cols.size(); i++)
+	{
+		Nullable& c = (*p.row)[i];
+		const Col_Array& a = b.cols[i];
+		const int width = c.maxsize();
+		char* dst = (char*) c.data();
+		const char* src = a.buf + r * width;
+		if (c.sqlt() == SQLT_STR)
+		{
+			// copy only the returned characters and terminate the string
+			int n = a.len[r] < width ? a.len[r] : width - 1;
+			std::memcpy(dst, src, n);
+			dst[n] = '\0';
+		}
+		else
+			std::memcpy(dst, src, width);
+		*c.ind_addr() = a.ind[r];
+		if (c.len_addr())
+			*c.len_addr() = a.len[r];
+	}
+	p.loaded = true;
+}
+
+
+int
+Oracle::Parallel_Select::next_ready() throw(Oracle::Error)
+{
+	const int n = parts.size();
+	pthread_mutex_lock(&mtx);
+	for (;;)
+	{
+		bool all_done = true;
+		for (int k=0; k < n; k++)
+		{
+			Part& p = parts[(rr + k) % n];
+			if (p.err)
+			{
+				Error* e = p.err->clone();
+				pthread_mutex_unlock(&mtx);
+				try
+				{
+					e->raise();
+				}
+				catch (Error&)
+				{
+					delete e;
+					throw;
+				}
+			}
+			if (p.count)
+			{
+				if (!p.loaded)
+					load(p);
+				rr = (p.id + 1) % n;
+				pthread_mutex_unlock(&mtx);
+				return p.id;
+			}
+			if (!p.done)
+				all_done = false;
+		}
+		if (all_done)
+		{
+			pthread_mutex_unlock(&mtx);
+			return -1;
+		}
+		pthread_cond_wait(&ready_cv, &mtx);
+	}
+}
+
+
+int
+Oracle::Parallel_Select::next_ordered() throw(Oracle::Error)
+{
+	// every partition that still has rows must offer one before the
+	// smallest can be chosen
+	pthread_mutex_lock(&mtx);
+	for (;;)
+	{
+		bool waiting = false;
+		int best = -1;
+		for (int i=0; i < parts.size(); i++)
+		{
+			Part& p = parts[i];
+			if (p.err)
+			{
+				Error* e = p.err->clone();
+				pthread_mutex_unlock(&mtx);
+				try
+				{
+					e->raise();
+				}
+				catch (Error&)
+				{
+					delete e;
+					throw;
+				}
+			}
+			if (!p.count)
+			{
+				if (!p.done)
+					waiting = true;
+				continue;
+			}
+			if (!p.loaded)
+				load(p);
+			if (best < 0 || less(*p.row, *parts[best].row))
+				best = i;
+		}
+		if (!waiting)
+		{
+			pthread_mutex_unlock(&mtx);
+			return best;
+		}
+		pthread_cond_wait(&ready_cv, &mtx);
+	}
+}
+
+
+const Oracle::Rowtype&
+Oracle::Parallel_Select::row() const throw(Oracle::Error)
+{
+	if (cur < 0)
+	{
+		State_Error e("Parallel_Select::row()", "No current row");
+		e.desc << "statement = {" << sql << "}";
+		throw e;
+	}
+	return *parts[cur].row;
+}
+
+
+double
+Oracle::Parallel_Select::secs() const throw()
+{
+	if (!t0)
+		return 0;
+	return (t1 ? t1 : Env::now()) - t0;
+}
+
+
+double
+Oracle::Parallel_Select::rows_per_sec() const throw()
+{
+	double t = secs();
+	return t > 0 ? total_rows / t : 0;
+}
+
+
+void
+Oracle::Parallel_Select::close() throw()
+{
+	// wake any worker waiting for a free block and wait for all of them
+	pthread_mutex_lock(&mtx);
+	stopping = true;
+	pthread_cond_broadcast(&taken_cv);
+	pthread_mutex_unlock(&mtx);
+
+	for (int i=0; i < parts.size(); i++)
+	{
+		Part& p = parts[i];
+		if (p.started)
+			pthread_join(p.thr, 0);
+		p.started = false;
+		free_blocks(p);
+		delete p.stmt;
+		p.stmt = 0;
+		delete p.err;
+		p.err = 0;
+		p.count = 0;
+		p.done = true;
+	}
+
+	stopping = false;
+	running = false;
+	cur = -1;
+}
@@ -0,0 +1,192 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Ora++ -- a C++ interface to Oracle based on the Oracle Call Interface
+// Copyright (C) 2000-1 James Edwin Cain <me@jimcain.net>
+// 
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or any
+// later version.
+// 
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef ORAPP_PARALLEL_SELECT_H
+#define ORAPP_PARALLEL_SELECT_H
+
+#include "Oracle.h"
+#include "Nullable.h"
+#include <string>
+#include <vector>
+#include <pthread.h>
+
+
+namespace Oracle
+{
+	class Connection;
+	class Rowtype;
+	class Select_Stmt;
+
+	// Runs one SELECT as N partitions, each on its own Connection and
+	// worker thread, and merges the rows into a single stream.  Each
+	// partition reads a disjoint part of the data:
+	//
+	//	split_rowid()	The query must contain the placeholders :lo and :hi
+	//			in a predicate on the ROWID of the table being split,
+	//			e.g. "... FROM big b WHERE b.ROWID BETWEEN :lo AND :hi".
+	//			exec() reads the table's extent map and binds each
+	//			partition an equal share of its blocks as a ROWID
+	//			range, so each session scans only its own blocks.
+	//	split_range()	Equal-width ranges of a numeric expression, added
+	//			as SELECT * FROM (query) WHERE <range>; the optimizer
+	//			can push the range into the query and use an index.
+	//
+	// Workers array-fetch blocks of rows and queue them to the reader
+	// through a bounded queue per partition, so the reader synchronizes
+	// with a worker once per block, not once per row.  The Connections must
+	// not be used by anything else while the query is running.  For an
+	// ordered merge, set_order() gives each partition an ORDER BY and the
+	// rows are merged with the matching less function.
+	class Parallel_Select
+	{
+		public:
+			// types
+			enum split_t { None, Range, Rowid };
+			typedef bool (*less_fn)(const Rowtype&, const Rowtype&);
+
+			struct Part_Stats						// per-partition timings
+			{
+				std::string sql;					// partition query
+				std::string lo;						// ROWID range (Rowid split)
+				std::string hi;
+				long rows;						// rows fetched
+				long blocks;						// array fetches queued
+				double exec_secs;					// time to execute
+				double wait_secs;					// time blocked on a full queue
+				double secs;						// time from start to last row
+				double rows_per_sec;					// rows / secs
+			};
+
+			// constructors/destructor
+			Parallel_Select(
+				const std::vector<Connection*>&,			// one Connection per partition
+				const std::string&)			throw(Error);	// SELECT statement
+			virtual ~Parallel_Select()			throw();
+
+			// implementors
+			void split_range(						// equal-width ranges of expr
+				const std::string&,					// numeric expression
+				const double,						// low bound
+				const double)				throw(Error);	// high bound
+			void split_rowid(						// ROWID ranges from the extent map
+				const std::string&,					// table name
+				const std::string& = "")		throw(Error);	// owner (default: current user)
+			void set_order(							// merge partitions in order
+				const std::string&,					// ORDER BY list for each partition
+				less_fn)				throw(Error);	// same ordering on rows
+			void set_array_size(const int)			throw(Error);	// rows per worker fetch (default 100)
+			void set_queue_depth(const int)			throw(Error);	// blocks queued per worker (default 3)
+			void exec()					throw(Error);	// start the workers
+			bool fetch()					throw(Error);	// get next row
+			void close()					throw();	// stop workers, release statements
+
+			// accessors
+			const Rowtype& row() const			throw(Error);	// current row
+			int partition() const				throw()		// partition of current row
+				{ return cur; }
+			int nparts() const				throw()		// number of partitions
+				{ return parts.size(); }
+			std::string part_sql(const int) const		throw(Error);	// query run by partition
+			const std::vector<Part_Stats>& stats() const	throw()		// per-partition timings
+				{ return pstats; }
+			long nrows() const				throw()		// rows returned so far
+				{ return total_rows; }
+			double secs() const				throw();	// elapsed time of exec() and fetches
+			double rows_per_sec() const			throw();	// overall throughput
+
+		protected:
+			// types
+			struct Col_Array						// one column of a block
+			{
+				char* buf;						// values
+				sb2* ind;						// null indicators
+				ub2* len;						// value lengths
+			};
+
+			struct Block							// one array fetch
+			{
+				std::vector<Col_Array> cols;
+				int rows;
+			};
+
+			struct Part							// one partition worker
+			{
+				Parallel_Select* owner;
+				int id;							// partition number
+				Connection* conn;
+				Select_Stmt* stmt;
+				Rowtype* row;						// reader's copy of the current row
+				std::vector<Block> q;					// ring of blocks
+				int head;						// next block to read
+				int tail;						// next block to fill
+				int count;						// blocks filled, not yet read
+				int pos;						// row within head block
+				bool loaded;						// row holds (head, pos)
+				bool done;						// worker has queued its last block
+				pthread_t thr;
+				bool started;						// thread was created
+				Error* err;						// error raised by worker
+			};
+
+			// protected implementors
+			void run(Part&)					throw();	// worker body
+			void init_blocks(Part&)				throw(Error);	// describe and allocate the ring
+			void free_blocks(Part&)				throw();
+			void define_block(Part&, Block&)		throw(Error);	// point the defines at a block
+			void plan_rowid()				throw(Error);	// ROWID range per partition
+			void load(Part&)				throw();	// copy current row into Part::row
+			int next_ready()				throw(Error);	// wait for a row (unordered)
+			int next_ordered()				throw(Error);	// wait for a row (ordered)
+			void advance()					throw();	// move past the current row
+			void check_idle(const std::string&) const	throw(Error);
+			static void* thread_main(void*);
+
+			// data members
+			std::string sql;						// query text
+			split_t split;							// partitioning method
+			std::string split_expr;						// expression (Range) or table (Rowid)
+			std::string owner;						// table owner (Rowid)
+			double lo, hi;							// bounds for Range
+			std::string order_by;						// ORDER BY for ordered merge
+			less_fn less;							// 0 for unordered merge
+			int arr_sz;							// rows per worker fetch
+			int depth;							// blocks per queue
+			std::vector<Part> parts;
+			std::vector<Part_Stats> pstats;
+			pthread_mutex_t mtx;						// guards queues, err, pstats
+			pthread_cond_t ready_cv;					// a block was queued (to reader)
+			pthread_cond_t taken_cv;					// a block was freed (to workers)
+			bool running;							// exec() called, not closed
+			bool stopping;							// close() in progress
+			int cur;							// partition holding current row
+			int rr;								// round-robin start for unordered merge
+			long total_rows;
+			double t0;							// exec() time
+			double t1;							// time last row was returned
+
+		private:
+			// disallowed functions
+			Parallel_Select(const Parallel_Select&);
+			Parallel_Select& operator=(const Parallel_Select&);
+	};
+}
+
+#endif
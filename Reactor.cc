@@ -0,0 +1,168 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Ora++ -- a C++ interface to Oracle based on the Oracle Call Interface
+// Copyright (C) 2000-1 James Edwin Cain <me@jimcain.net>
+// 
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or any
+// later version.
+// 
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#include "Reactor.h"
+#include "Connection.h"
+#include "Select_Stmt.h"
+#include <time.h>
+
+
+Oracle::Reactor::Reactor() throw()
+	: npending(0), wait_min(50), wait_max(10000)
+{
+}
+
+
+Oracle::Reactor::~Reactor() throw()
+{
+	for (int i=0; i < db_v.size(); i++)
+		delete db_v[i];
+}
+
+
+void
+Oracle::Reactor::add(Connection* db) throw(Oracle::Error)
+{
+	db->set_nonblocking(true);
+	db_v.push_back(db);
+}
+
+
+Oracle::Connection&
+Oracle::Reactor::connection(const int n) const throw(Oracle::Error)
+{
+	if (n < 0 || n >= db_v.size())
+	{
+		Value_Error e("Reactor::connection", "Subscript out of range");
+		e.desc << "subscript = " << n << "; connections = " << db_v.size();
+		throw e;
+	}
+	return *db_v[n];
+}
+
+
+void
+Oracle::Reactor::set_wait(const int lo, const int hi) throw(Oracle::Error)
+{
+	if (lo < 1 || hi < lo)
+	{
+		Value_Error e("Reactor::set_wait(const int, const int)", "Wait times out of range");
+		e.desc << "first = " << lo << "; longest = " << hi;
+		throw e;
+	}
+	wait_min = lo;
+	wait_max = hi;
+}
+
+
+void
+Oracle::Reactor::exec(Stmt& s, Handler& h) throw(Oracle::Error)
+{
+	queue(s, Pending::Exec, h);
+}
+
+
+void
+Oracle::Reactor::fetch(Select_Stmt& s, Handler& h) throw(Oracle::Error)
+{
+	queue(s, Pending::Fetch, h);
+}
+
+
+void
+Oracle::Reactor::queue(Stmt& s, const Pending::op_t op, Handler& h) throw(Oracle::Error)
+{
+	// a statement with no Connection is a queue of its own
+	const void* key = s.db_ ? (const void*) s.db_ : (const void*) &s;
+	q_m[key].push_back(Call(s, op, h));
+	npending++;
+}
+
+
+int
+Oracle::Reactor::run_once() throw(Oracle::Error)
+{
+	// Only the call at the front of each queue is in progress.  Handlers
+	// may queue more calls, which can add map entries and deque elements,
+	// so the front is copied off before its handler runs.
+	int ndone = 0;
+	for (queue_map::iterator i = q_m.begin(); i != q_m.end(); i++)
+	{
+		std::deque<Call>& q = i->second;
+		if (q.empty())
+			continue;
+
+		Call& c = q.front();
+		Error* err = 0;
+		try
+		{
+			if (!c.p.poll())
+				continue;
+		}
+		catch (Error& e)
+		{
+			err = e.clone();
+		}
+
+		Call done = c;
+		q.pop_front();
+		npending--;
+		ndone++;
+		if (!err)
+		{
+			done.h->done(*this, done.p);
+			continue;
+		}
+		try
+		{
+			done.h->failed(*this, done.p, *err);
+		}
+		catch (...)
+		{
+			delete err;
+			throw;
+		}
+		delete err;
+	}
+	return ndone;
+}
+
+
+void
+Oracle::Reactor::run() throw(Oracle::Error)
+{
+	// sleep while every call is waiting on the network, longer the
+	// longer nothing completes
+	int us = wait_min;
+	while (npending)
+	{
+		if (run_once())
+		{
+			us = wait_min;
+			continue;
+		}
+		struct timespec ts;
+		ts.tv_sec = us / 1000000;
+		ts.tv_nsec = (us % 1000000) * 1000L;
+		nanosleep(&ts, 0);
+		us = us * 2 < wait_max ? us * 2 : wait_max;
+	}
+}
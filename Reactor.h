@@ -0,0 +1,115 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Ora++ -- a C++ interface to Oracle based on the Oracle Call Interface
+// Copyright (C) 2000-1 James Edwin Cain <me@jimcain.net>
+// 
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or any
+// later version.
+// 
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef ORAPP_REACTOR_H
+#define ORAPP_REACTOR_H
+
+#include "Oracle.h"
+#include "Stmt.h"
+#include <map>
+#include <deque>
+#include <vector>
+
+
+namespace Oracle
+{
+	class Connection;
+	class Select_Stmt;
+	class Reactor;
+
+	// Receives the completion of a call queued on a Reactor.  Handlers run
+	// in the thread calling Reactor::run() and may queue further calls,
+	// e.g. fetch the next row from done().
+	class Handler
+	{
+		public:
+			virtual ~Handler() {}
+			virtual void done(					// call completed
+				Reactor&,					// reactor it ran on
+				Pending&)			throw(Error) = 0; // completed call
+			virtual void failed(					// call raised an error
+				Reactor&,
+				Pending&,
+				Error& e)			throw(Error)	// error (rethrown by default)
+				{ e.raise(); }
+	};
+
+
+	// Drives the executes and fetches of many Connections in non-blocking
+	// mode from one thread.  Calls are queued per Connection, because OCI
+	// allows one call at a time on a session; calls on different
+	// Connections proceed together, and run() polls each in turn.  When a
+	// pass completes nothing, run() sleeps, doubling the sleep after each
+	// idle pass up to a limit, and starts again from the shortest sleep
+	// once a call completes.
+	class Reactor
+	{
+		public:
+			// constructors/destructor
+			Reactor()					throw();
+			virtual ~Reactor()				throw();	// deletes adopted Connections
+
+			// implementors
+			void add(Connection*)				throw(Error);	// adopt and make non-blocking
+			void exec(Stmt&, Handler&)			throw(Error);	// queue exec()
+			void fetch(Select_Stmt&, Handler&)		throw(Error);	// queue fetch()
+			void set_wait(							// sleep between idle passes of run()
+				const int,						// first sleep in microseconds (default 50)
+				const int)				throw(Error);	// longest sleep (default 10000)
+			int run_once()					throw(Error);	// poll every call once, returns #completed
+			void run()					throw(Error);	// poll until no calls remain
+
+			// accessors
+			int pending() const				throw()		// calls queued or in progress
+				{ return npending; }
+			int connections() const				throw()		// adopted Connections
+				{ return db_v.size(); }
+			Connection& connection(const int) const		throw(Error);	// adopted Connection by index
+
+		protected:
+			// types
+			struct Call							// queued call
+			{
+				Call(Stmt& s, const Pending::op_t o, Handler& h)
+					: p(s, o), h(&h) {}
+				Pending p;						// first poll() starts the call
+				Handler* h;
+			};
+			typedef std::map<const void*, std::deque<Call> > queue_map;
+
+			// protected implementors
+			void queue(Stmt&, const Pending::op_t, Handler&) throw(Error);
+
+			// data members
+			std::vector<Connection*> db_v;					// adopted Connections
+			queue_map q_m;							// calls, by Connection
+			int npending;
+			int wait_min;							// microseconds
+			int wait_max;
+
+		private:
+			// disallowed functions
+			Reactor(const Reactor&);
+			Reactor& operator=(const Reactor&);
+	};
+}
+
+#endif
@@ -27,15 +27,46 @@
 #include "Date.h"
 #include "Select_Stmt.h"
 #include <oci.h>
+#include <new>
+
+
+namespace
+{
+	// alignment of the arena and of each object/buffer within it
+	const int arena_align = 64;
+	const int slot_align = 16;
+
+	inline int
+	align_up(const int n, const int a)
+	{
+		return (n + a - 1) / a * a;
+	}
+}
 
 
 Oracle::Rowtype::Rowtype() throw(Oracle::Error)
-	: stmt_h(0), err_h(0), col_vec(0), col_name_m(0), col_name(0)
+	: stmt_h(0), err_h(0), col_vec(0), col_name(0), col_idx(0), row_sz(0),
+	lay(Separate), arena(0), arena_n(0)
+{
+}
+
+
+Oracle::Rowtype::Rowtype(const layout_t l) throw(Oracle::Error)
+	: stmt_h(0), err_h(0), col_vec(0), col_name(0), col_idx(0), row_sz(0),
+	lay(l), arena(0), arena_n(0)
 {
 }
 
 
 Oracle::Rowtype::Rowtype(const Select_Stmt& stmt) throw(Oracle::Error)
+	: col_vec(0), col_name(0), col_idx(0), row_sz(0), lay(Separate), arena(0), arena_n(0)
+{
+	init_data(stmt);
+}
+
+
+Oracle::Rowtype::Rowtype(const Select_Stmt& stmt, const layout_t l) throw(Oracle::Error)
+	: col_vec(0), col_name(0), col_idx(0), row_sz(0), lay(l), arena(0), arena_n(0)
 {
 	init_data(stmt);
 }
@@ -43,13 +74,18 @@ Oracle::Rowtype::Rowtype(const Select_Stmt& stmt) throw(Oracle::Error)
 
 Oracle::Rowtype::~Rowtype() throw()
 {
-	// release any allocated Nullable objects
+	// release any allocated Nullable objects; those living in the
+	// arena are destroyed in place and freed with it
 	if (col_vec)
 	{
 		for (int i=0; i<col_vec->size(); i++)
-			delete (*col_vec)[i];
+			if (i < arena_n)
+				(*col_vec)[i]->~Nullable();
+			else
+				delete (*col_vec)[i];
 		delete col_vec;
 	}
+	delete [] arena;
 
 	// release the column name vector
 	if (col_name)
@@ -58,12 +94,8 @@ Oracle::Rowtype::~Rowtype() throw()
 		delete col_name;
 	}
 
-	// release the column name -> position map
-	if (col_name_m)
-	{
-		col_name_m->clear();
-		delete col_name_m;
-	}
+	// release the column name -> position index
+	delete col_idx;
 }
 
 
@@ -74,18 +106,20 @@ Oracle::Rowtype::init_data(const Select_Stmt& stmt) throw(Oracle::Error)
 	stmt_h = stmt.stmt_handle();
 	err_h = stmt.err_handle();
 	col_vec = new std::vector<Nullable*>(stmt.ncols());		// vector of ptrs to Nullables
-	col_name = new std::vector<std::string>(stmt.ncols());		// vector of column names
-	col_name_m = new std::map<std::string, int>(*stmt.cnamem_);	// map of column name -> position
+	col_name = new std::vector<std::string>(*stmt.cnamev_);		// vector of column names
+	col_idx = new Name_Index;						// column name -> position
 
-	// create map of column names and array of column values for fetch
-	for (std::map<std::string, int>::const_iterator i = col_name_m->begin(); i != col_name_m->end(); i++)
-		(*col_name)[i->second] = i->first;
+	// index the column names
+	for (int i=0; i < col_name->size(); i++)
+		col_idx->add((*col_name)[i], i);
 
 	OCIParam* parm_h;
 	short precision(0);
 	short scale(0);
 	ub2 col_type;
 	ub2 col_size;
+	std::vector<int> type_v(stmt.ncols());				// column types
+	std::vector<int> size_v(stmt.ncols());				// column sizes
 
 	for(int i=0; i < stmt.ncols(); i++)
 	{
@@ -136,25 +170,107 @@ Oracle::Rowtype::init_data(const Select_Stmt& stmt) throw(Oracle::Error)
 					err_h))
 				throw OCI_Error("Rowtype::init_data", err_h);
 
-		// create an appropriate Nullable object
 		switch(col_type)
 		{
 			case 1:		// VARCHAR2
 			case 11:	// ROWID
 			case 96:	// CHAR
-				(*col_vec)[i] = new Varchar(col_size);
+			case 2:		// NUMBER
+			case 12:	// DATE
+				break;
+
+			default:
+				throw Type_Error("Rowtype::init_data", "Unsupported Oracle internal data type");
+		}
+		type_v[i] = col_type;
+		size_v[i] = col_size;
+	}
+
+	if (lay == Arena)
+		init_arena(type_v, size_v);
+	else
+		for(int i=0; i < stmt.ncols(); i++)
+			switch(type_v[i])
+			{
+				case 2:		// NUMBER
+					(*col_vec)[i] = new Number;
+					break;
+
+				case 12:	// DATE
+					(*col_vec)[i] = new Date;
+					break;
+
+				default:	// VARCHAR2, ROWID, CHAR
+					(*col_vec)[i] = new Varchar(size_v[i]);
+					break;
+			}
+
+	// keep a running total of the row width
+	for(int i=0; i < stmt.ncols(); i++)
+		row_sz += (*col_vec)[i]->maxsize() + sizeof(sb2);
+}
+
+
+void
+Oracle::Rowtype::init_arena(const std::vector<int>& type_v, const std::vector<int>& size_v) throw(Oracle::Error)
+{
+	// lay out each column as its Nullable object (which carries the
+	// indicator and length) followed by its value buffer
+	std::vector<int> off_v(type_v.size());
+	int total = 0;
+	for (int i=0; i < type_v.size(); i++)
+	{
+		off_v[i] = total;
+		switch(type_v[i])
+		{
+			case 2:		// NUMBER
+				total += align_up(sizeof(Number), slot_align) + sizeof(OCINumber);
 				break;
 
+			case 12:	// DATE
+				total += align_up(sizeof(Date), slot_align) + sizeof(OCIDate);
+				break;
+
+			default:	// VARCHAR2, ROWID, CHAR
+				total += align_up(sizeof(Varchar), slot_align) + size_v[i] + 1;
+				break;
+		}
+		total = align_up(total, slot_align);
+	}
+
+	// one allocation, aligned to a cache line
+	try
+	{
+		arena = new char[total + arena_align];
+	}
+	catch (std::bad_alloc&)
+	{
+		Error e("Rowtype::init_arena", "Could not allocate column arena");
+		e.desc << "size = " << total + arena_align;
+		throw e;
+	}
+	char* base = arena + (arena_align - ((unsigned long) arena % arena_align)) % arena_align;
+
+	for (arena_n=0; arena_n < type_v.size(); arena_n++)
+	{
+		char* obj = base + off_v[arena_n];
+		char* val;
+		switch(type_v[arena_n])
+		{
 			case 2:		// NUMBER
-				(*col_vec)[i] = new Number;
+				val = obj + align_up(sizeof(Number), slot_align);
+				(*col_vec)[arena_n] = new (obj) Number((OCINumber*) val);
 				break;
 
 			case 12:	// DATE
-				(*col_vec)[i] = new Date;
+				val = obj + align_up(sizeof(Date), slot_align);
+				(*col_vec)[arena_n] = new (obj) Date((OCIDate*) val);
 				break;
 
-			default:
-				throw Type_Error("Rowtype::init_data", "Unsupported Oracle internal data type");
+			default:	// VARCHAR2, ROWID, CHAR
+				val = obj + align_up(sizeof(Varchar), slot_align);
+				(*col_vec)[arena_n] = new (obj) Varchar(val, size_v[arena_n]);
+				break;
 		}
 	}
 }
@@ -181,11 +297,12 @@ Oracle::Rowtype::add(Oracle::Nullable* n, const std::string& s) throw()
 	{
 		col_vec = new std::vector<Nullable*>(1);
 		col_name = new std::vector<std::string>(1);
-		col_name_m = new std::map<std::string, int>;
+		col_idx = new Name_Index;
 		(*col_vec)[0] = n;
 		(*col_name)[col_vec->size() - 1] = s;
 	}
-	(*col_name_m)[s] = col_vec->size() - 1;
+	col_idx->add(s, col_vec->size() - 1);
+	row_sz += n->maxsize() + sizeof(sb2);
 }
 
 
@@ -207,6 +324,16 @@ Oracle::Rowtype::throw_subscript_error(const std::string& module, const std::str
 }
 
 
+Oracle::Col_Handle
+Oracle::Rowtype::resolve(const std::string& s) const throw(Oracle::Error)
+{
+	int i = col_idx ? col_idx->find(s) : -1;
+	if (i < 0)
+		throw_subscript_error("Rowtype::resolve(const std::string&)", s);
+	return Col_Handle(i);
+}
+
+
 int
 Oracle::Rowtype::ncols() const throw()
 {
@@ -24,7 +24,7 @@
 
 #include <iostream>
 #include <vector>
-#include <map>
+#include "Name_Index.h"
 
 
 class OCIStmt;
@@ -39,9 +39,14 @@ namespace Oracle
 	class Rowtype
 	{
 		public:
+			// types
+			enum layout_t { Separate, Arena };				// column storage layout
+
 			// constructors/destructor
 			Rowtype()					throw(Error);	// create empty Rowtype object
+			Rowtype(const layout_t)				throw(Error);	// create empty Rowtype object
 			Rowtype(const Select_Stmt&)			throw(Error);	// initialize with select list types
+			Rowtype(const Select_Stmt&, const layout_t)	throw(Error);	// ... using given layout
 			virtual ~Rowtype()				throw();
 
 			// implementors
@@ -51,22 +56,40 @@ namespace Oracle
 				{ if (col_vec && i >= 0 && i < col_vec->size()) return *(*col_vec)[i];
 				else throw_subscript_error("Rowtype::operator[](const int)", i); }
 			Nullable& operator[](const std::string& s)	throw(Error)
-				{ if (col_name_m->count(s)) return *(*col_vec)[(*col_name_m)[s]];
+				{ int i = col_idx ? col_idx->find(s) : -1; if (i >= 0) return *(*col_vec)[i];
 				else throw_subscript_error("Rowtype::operator[](const std::string&)", s); }
+			Nullable& operator[](const char* s)		throw(Error)
+				{ int i = col_idx ? col_idx->find(s) : -1; if (i >= 0) return *(*col_vec)[i];
+				else throw_subscript_error("Rowtype::operator[](const char*)", s); }
+			inline Nullable& operator[](const Col_Handle h)	throw(Error)
+				{ if (col_vec && h.pos >= 0 && h.pos < col_vec->size()) return *(*col_vec)[h.pos];
+				else throw_subscript_error("Rowtype::operator[](const Col_Handle)", h.pos); }
 
 			// accessors
 			int ncols() const				throw();
+			int width() const				throw()		// bytes per row
+				{ return row_sz; }
+			layout_t layout() const				throw()		// column storage layout
+				{ return lay; }
 			std::string colname(const int) const		throw(Error);
 			inline const Nullable& operator[](const int i) const throw(Error)
 				{ if (col_vec && i >= 0 && i < col_vec->size()) return *(*col_vec)[i];
 				else throw_subscript_error("Rowtype::operator[](const int)", i); }
 			const Nullable& operator[](const std::string& s) const throw(Error)
-				{ if (col_name_m->count(s)) return *(*col_vec)[(*col_name_m)[s]];
+				{ int i = col_idx ? col_idx->find(s) : -1; if (i >= 0) return *(*col_vec)[i];
 				else throw_subscript_error("Rowtype::operator[](const std::string&)", s); }
+			const Nullable& operator[](const char* s) const	throw(Error)
+				{ int i = col_idx ? col_idx->find(s) : -1; if (i >= 0) return *(*col_vec)[i];
+				else throw_subscript_error("Rowtype::operator[](const char*)", s); }
+			inline const Nullable& operator[](const Col_Handle h) const throw(Error)
+				{ if (col_vec && h.pos >= 0 && h.pos < col_vec->size()) return *(*col_vec)[h.pos];
+				else throw_subscript_error("Rowtype::operator[](const Col_Handle)", h.pos); }
+			Col_Handle resolve(const std::string&) const	throw(Error);	// look up a column once
 
 		protected:
 			// protected implementors
 			void init_data(const Select_Stmt&)		throw(Error);
+			void init_arena(const std::vector<int>&, const std::vector<int>&) throw(Error); // construct columns in one arena
 			void throw_subscript_error(const std::string&, const int) const throw(Error);
 			void throw_subscript_error(const std::string&, const std::string&) const throw(Error);
 
@@ -75,7 +98,11 @@ namespace Oracle
 			OCIError* err_h;
 			std::vector<Nullable*>* col_vec;
 			std::vector<std::string>* col_name;
-			std::map<std::string, int>* col_name_m;
+			Name_Index* col_idx;						// column name -> position
+			int row_sz;							// sum of column sizes
+			layout_t lay;							// column storage layout
+			char* arena;							// single allocation for Arena layout
+			int arena_n;							// #columns constructed in arena
 
 		friend class Stmt;
 		friend class Select_Stmt;
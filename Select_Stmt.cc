@@ -22,30 +22,42 @@
 #include "Select_Stmt.h"
 #include "Connection.h"
 #include "Varchar.h"
+#include "Env.h"
 #include <cstdio>
+#include <cstring>
 #include <cstdarg>
+#include <algorithm>
 #include <oci.h>
 
 
 Oracle::Select_Stmt::Select_Stmt() throw(Oracle::Error)
-	: Stmt(), nc(0), cnamem_(0), cnamev_(0), row_(0)
+	: Stmt(), nc(0), cindex_(0), cnamev_(0), row_(0),
+	  arr_sz(1), blk_rows(0), blk_pos(0), nfetched(0), blk_last(false), pf_auto(0),
+	  row_lay(Rowtype::Separate), bg(false), refill_err_h(0), refill_on(false), refill_live(false),
+	  refill_go(false), refill_quit(false), refill_rc(0), batch_(0)
 {
 }
 
 
 Oracle::Select_Stmt::Select_Stmt(Connection& db) throw(Oracle::Error)
-	: Stmt(db), nc(0), cnamem_(0), cnamev_(0), row_(0)
+	: Stmt(db), nc(0), cindex_(0), cnamev_(0), row_(0),
+	  arr_sz(1), blk_rows(0), blk_pos(0), nfetched(0), blk_last(false), pf_auto(0),
+	  row_lay(Rowtype::Separate), bg(false), refill_err_h(0), refill_on(false), refill_live(false),
+	  refill_go(false), refill_quit(false), refill_rc(0), batch_(0)
 {
 }
 
 
 Oracle::Select_Stmt::Select_Stmt(Connection& db, const std::string& sql) throw(Oracle::Error)
-	: Stmt(db, sql), nc(0), cnamem_(0), cnamev_(0), row_(0)
+	: Stmt(db, sql), nc(0), cindex_(0), cnamev_(0), row_(0),
+	  arr_sz(1), blk_rows(0), blk_pos(0), nfetched(0), blk_last(false), pf_auto(0),
+	  row_lay(Rowtype::Separate), bg(false), refill_err_h(0), refill_on(false), refill_live(false),
+	  refill_go(false), refill_quit(false), refill_rc(0), batch_(0)
 {
 	// make sure this is actually a SELECT statement
 	if (oci_type() != OCI_STMT_SELECT)
 	{
-		OCIHandleFree((dvoid *)stmt_h, (ub4)OCI_HTYPE_STMT);
+		free_handle();
 		delete stmt_p;
 		st = Invalid;
 		Type_Error e("Select_Stmt::Select_Stmt(Connection&, const std::string&)", "Statement is not a SELECT statement");
@@ -56,7 +68,10 @@ Oracle::Select_Stmt::Select_Stmt(Connection& db, const std::string& sql) throw(O
 
 
 Oracle::Select_Stmt::Select_Stmt(OCIStmt* stmt_hdl, char* stmt_ptr, OCISvcCtx* svc_hdl, OCIError* err_hdl) throw()
-	: Stmt(stmt_hdl, stmt_ptr, svc_hdl, err_hdl), nc(0), cnamem_(0), cnamev_(0), row_(0)
+	: Stmt(stmt_hdl, stmt_ptr, svc_hdl, err_hdl), nc(0), cindex_(0), cnamev_(0), row_(0),
+	  arr_sz(1), blk_rows(0), blk_pos(0), nfetched(0), blk_last(false), pf_auto(0),
+	  row_lay(Rowtype::Separate), bg(false), refill_err_h(0), refill_on(false), refill_live(false),
+	  refill_go(false), refill_quit(false), refill_rc(0), batch_(0)
 {
 }
 
@@ -71,11 +86,76 @@ Oracle::Select_Stmt::~Select_Stmt() throw()
 void
 Oracle::Select_Stmt::exec() throw(Oracle::Error)
 {
+	// a block still being fetched belongs to the previous execute
+	if (refill_on)
+		finish_refill();
+
 	// Stmt::do_exec will validate state and set state to Executed if successful
 	// state will only be changed if it is not already Executed or higher
-	Stmt::do_exec(0);
+	if (!Stmt::do_exec(0))
+		return;
+
+	// a new result set starts with an empty fetch block
+	blk_rows = blk_pos = nfetched = 0;
+	blk_last = false;
 
 	get_column_info();
+
+	// defines made before a reset() are still in place
+	if (def_l.size() && st < Defined)
+		st = Defined;
+}
+
+
+void
+Oracle::Select_Stmt::reset() throw(Oracle::Error)
+{
+	// cancel the open cursor, if any; the defines are kept
+	if (refill_on)
+		finish_refill();
+	if (st >= Executed && !blk_last)
+		while (OCIStmtFetch(
+				stmt_h,							// stmt handle
+				err_h,							// error handle
+				(ub4) 0,						// #rows (0 cancels)
+				(ub4) OCI_FETCH_NEXT,					// orientation
+				(ub4) OCI_DEFAULT) == OCI_STILL_EXECUTING)		// mode
+			;
+	blk_rows = blk_pos = nfetched = 0;
+	blk_last = false;
+	Stmt::reset();
+}
+
+
+void
+Oracle::Select_Stmt::set_array_size(const int n) throw(Oracle::Error)
+{
+	// the fetch arrays are allocated when the columns are defined
+	if (st >= Defined || def_l.size())
+	{
+		State_Error e("Select_Stmt::set_array_size(const int)", "Columns have already been defined");
+		e.desc << "statement = {" << str() << "}";
+		throw e;
+	}
+	if (n < 1)
+	{
+		Value_Error e("Select_Stmt::set_array_size(const int)", "Array size must be at least 1");
+		e.desc << "size = " << n;
+		throw e;
+	}
+	arr_sz = n;
+}
+
+
+void
+Oracle::Select_Stmt::auto_prefetch(const int mem) throw(Oracle::Error)
+{
+	// The number of rows to prefetch is chosen so that a prefetch buffer of
+	// about mem bytes is used.  The row width is known once a Rowtype has been
+	// initialized by bind_col(Rowtype&); until then the setting is deferred.
+	pf_auto = mem;
+	if (row_)
+		set_prefetch_rows(row_->width() ? std::max(1, pf_auto / row_->width()) : 1);
 }
 
 
@@ -83,7 +163,7 @@ void
 Oracle::Select_Stmt::get_column_info() throw(Oracle::Error)
 {
 	// if column name setup has already been done, we're finished
-	if (cnamem_)
+	if (cnamev_)
 		return;
 
 	// get number of columns returned
@@ -101,8 +181,8 @@ Oracle::Select_Stmt::get_column_info() throw(Oracle::Error)
 	}
 	nc = col_count;
 
-	// set up vector of column names and map of column name -> number
-	cnamem_ = new std::map<std::string, int>;		// new map for col name -> number
+	// set up vector of column names and index of column name -> number
+	cindex_ = new Name_Index;			// new index for col name -> number
 	cnamev_ = new std::vector<std::string>(nc);	// new vector of nc strings
 	OCIParam* parm_h;
 	text* col_name;
@@ -125,7 +205,7 @@ Oracle::Select_Stmt::get_column_info() throw(Oracle::Error)
 			throw e;
 		}
 
-		// get column name and add it to col name vector and to col name -> number map
+		// get column name and add it to col name vector and to col name -> number index
 		if (OCIAttrGet(	(dvoid*) parm_h,
 				(ub4) OCI_DTYPE_PARAM, 
 				(dvoid*) &col_name,
@@ -138,7 +218,7 @@ Oracle::Select_Stmt::get_column_info() throw(Oracle::Error)
 			throw e;
 		}
 		(*cnamev_)[i] = std::string((char*)col_name, col_name_len);
-		(*cnamem_)[std::string((char*)col_name, col_name_len)] = i;
+		cindex_->add((*cnamev_)[i], i);
 	}
 }
 
@@ -163,28 +243,8 @@ Oracle::Select_Stmt::bind_col(Oracle::Nullable& bindobj) throw(Oracle::Error)
 		throw e;
 	}
 
-	// define by position based on size of bind handle list
-	OCIDefine* def_h;
-	if (OCIDefineByPos(
-			stmt_h,						// stmt handle
-			&def_h,						// define handle returned
-			err_h,						// error handle
-			def_l.size() + 1,				// position (one-based)
-			(dvoid*) bindobj.data(),			// output buffer
-			(sb4) bindobj.maxsize(),			// output buffer size
-			(ub2) bindobj.sqlt(),				// external data type
-			(dvoid*) bindobj.ind_addr(),			// indicator
-			(ub2*) 0,					// array of length values
-			(ub2*) 0,					// array of return codes
-			(ub4) OCI_DEFAULT))
-	{
-		OCI_Error e("Select_Stmt::bind_col(Nullable&)", err_h);
-		e.desc << "statement = {" << stmt_p << "}";
-		throw e;
-	}
-
-	// save the define handle
-	def_l.push_back(def_h);
+	// define by position based on size of define handle list
+	define_col(bindobj, def_l.size() + 1, "Select_Stmt::bind_col(Nullable&)");
 
 	// update the state
 	st = Defined;
@@ -213,31 +273,11 @@ Oracle::Select_Stmt::bind_col(Oracle::Nullable* n ...) throw(Oracle::Error)
 
 	va_list varg;
 	va_start(varg, n);
-	OCIDefine* def_h;
 	Nullable* bindobj(n);
 	for (int i = 0; i < nc; i++)
 	{
-		if (OCIDefineByPos(
-				stmt_h,					// stmt handle
-				&def_h,					// define handle returned
-				err_h,					// error handle
-				def_l.size() + 1,			// position (one-based)
-				(dvoid*) bindobj->data(),		// output buffer
-				(sb4) bindobj->maxsize(),		// output buffer size
-				(ub2) bindobj->sqlt(),			// external data type
-				(dvoid*) bindobj->ind_addr(),		// indicator
-				(ub2*) 0,				// array of length values
-				(ub2*) 0,				// array of return codes
-				(ub4) OCI_DEFAULT))
-		{
-			OCI_Error e("Select_Stmt::bind_col(Nullable* ...)", err_h);
-			e.desc << "statement = {" << stmt_p << "}; position = " << def_l.size() + 1;
-			throw e;
-		}
+		define_col(*bindobj, def_l.size() + 1, "Select_Stmt::bind_col(Nullable* ...)");
 
-		// save the define handle
-		def_l.push_back(def_h);
-		
 		// get next arg
 		bindobj = va_arg(varg, Nullable*);
 	}
@@ -272,35 +312,110 @@ Oracle::Select_Stmt::bind_col(Oracle::Rowtype& row) throw(Oracle::Error)
 	if (row.col_vec == 0)
 		row.init_data(*this);
 
+	// size the prefetch from the row width if requested
+	if (pf_auto && row.width())
+		set_prefetch_rows(std::max(1, pf_auto / row.width()));
+
 	// define by position for each column
-	OCIDefine* def_h;
 	for (int i=0; i < nc; i++)
+		define_col(row[i], i + 1, "Select_Stmt::bind_col(Rowtype&)");
+
+	// update the state
+	st = Defined;
+}
+
+
+void
+Oracle::Select_Stmt::set_background_fetch(const bool on) throw(Oracle::Error)
+{
+	// the second set of arrays is allocated when the columns are defined;
+	// fetching from another thread needs a threaded environment
+	if (st >= Defined || def_l.size())
 	{
-		def_h = 0;
-		if (OCIDefineByPos(
-				stmt_h,						// stmt handle
-				&def_h,						// define handle returned
-				err_h,						// error handle
-				i + 1,						// position (one-based)
-				(dvoid*) row[i].data(),				// output buffer
-				(sb4) row[i].maxsize(),				// output buffer size
-				(ub2) row[i].sqlt(),				// external data type
-				(dvoid*) row[i].ind_addr(),			// indicator
-				(ub2*) 0,					// array of length values
-				(ub2*) 0,					// array of return codes
-				(ub4) OCI_DEFAULT))
-		{
-			OCI_Error e("Select_Stmt::bind_col(Rowtype&)", err_h);
-			e.desc << "statement = {" << stmt_p << "}";
-			throw e;
-		}
+		State_Error e("Select_Stmt::set_background_fetch", "Columns have already been defined");
+		e.desc << "statement = {" << str() << "}";
+		throw e;
+	}
+	if (!on || !Env::threaded())
+	{
+		stop_refill();
+		bg = false;
+		return;
+	}
+	if (bg)
+		return;
 
-		// save the define handle
-		def_l.push_back(def_h);
+	// The refill thread lives as long as the statement and reports errors
+	// through its own handle, so they cannot be mixed up with those of
+	// calls made meanwhile on the same Connection.
+	if (OCIHandleAlloc(
+			(dvoid *) Env::env(),					// env handle
+			(dvoid **) &refill_err_h,				// handle returned
+			(ub4) OCI_HTYPE_ERROR,					// handle type
+			(size_t) 0,						// user-def memory size
+			(dvoid **) 0))						// user-def memory ptr
+		throw Error("Select_Stmt::set_background_fetch", "OCIHandleAlloc failed for error handle");
+
+	pthread_mutex_init(&refill_mtx, 0);
+	pthread_cond_init(&refill_cv, 0);
+	refill_go = refill_quit = false;
+	if (pthread_create(&refill_thr, 0, refill_main, this))
+	{
+		pthread_cond_destroy(&refill_cv);
+		pthread_mutex_destroy(&refill_mtx);
+		OCIHandleFree((dvoid *) refill_err_h, (ub4) OCI_HTYPE_ERROR);
+		refill_err_h = 0;
+		throw Error("Select_Stmt::set_background_fetch", "Cannot create fetch thread");
 	}
+	refill_live = true;
+	bg = true;
+}
 
-	// update the state
-	st = Defined;
+
+void
+Oracle::Select_Stmt::set_row_layout(const Rowtype::layout_t l) throw(Oracle::Error)
+{
+	// the internal row is created on the first fetch()
+	if (row_ || st >= Defined)
+	{
+		State_Error e("Select_Stmt::set_row_layout", "Columns have already been defined");
+		e.desc << "statement = {" << str() << "}";
+		throw e;
+	}
+	row_lay = l;
+}
+
+
+Oracle::Pending
+Oracle::Select_Stmt::fetch_async() throw(Oracle::Error)
+{
+	// Pending::row() tells whether a row was fetched
+	Pending p(*this, Pending::Fetch);
+	p.poll();
+	return p;
+}
+
+
+Oracle::Select_Stmt::iterator
+Oracle::Select_Stmt::begin() throw(Oracle::Error)
+{
+	// Iteration always goes through the internal Rowtype, so columns must
+	// not have been defined some other way.  Rows are fetched in arrays of
+	// default_iter_array unless an array size was already chosen, so each
+	// increment is normally a copy from the fetch arrays.
+	if ((st >= Defined || def_l.size()) && !row_)
+	{
+		State_Error e("Select_Stmt::begin()", "Columns are not defined by a Rowtype");
+		e.desc << "statement = {" << str() << "}";
+		throw e;
+	}
+	if (def_l.empty() && st < Defined)
+	{
+		if (arr_sz == 1)
+			set_array_size(default_iter_array);
+	}
+
+	return fetch() ? iterator(this) : iterator();
 }
 
 
@@ -309,23 +424,46 @@ Oracle::Select_Stmt::fetch() throw(Oracle::Error)
 {
 	// execute statement if not already done
 	if (st < Executed)
+	{
 		exec();
+		if (busy_)
+			return false;
+	}
 
 	// if columns not defined yet, create Rowtype object and bind to it
 	// bind_col() will set the state to Defined if successful
 	if (st == Executed)
 	{
-		row_ = new Rowtype(*this);
+		row_ = new Rowtype(*this, row_lay);
 		bind_col(*row_);
 	}
 
-	switch (OCIStmtFetch(
+	if (batch_)
+	{
+		State_Error e("Select_Stmt::fetch()", "Columns are defined for fetch_batch()");
+		e.desc << "statement = {" << stmt_p << "}";
+		throw e;
+	}
+
+	// in array mode, rows are served from the current fetch block
+	if (arr_v.size())
+		return fetch_array();
+
+	sword rc;
+	do
+		rc = OCIStmtFetch(
 			stmt_h,								// stmt handle
 			err_h,								// error handle
 			(ub4) 1,							// #rows to fetch
 			(ub4) OCI_FETCH_NEXT,						// orientation
-			(ub4) OCI_DEFAULT))						// mode
+			(ub4) OCI_DEFAULT);						// mode
+	while (rc == OCI_STILL_EXECUTING && !async_);
+
+	busy_ = rc == OCI_STILL_EXECUTING;
+	switch (rc)
 	{
+		case OCI_STILL_EXECUTING:
+			return false;
 		case OCI_SUCCESS:
 		case OCI_SUCCESS_WITH_INFO:
 			st = Fetched;
@@ -340,6 +478,489 @@ Oracle::Select_Stmt::fetch() throw(Oracle::Error)
 }
 
 
+void
+Oracle::Select_Stmt::define_col(Nullable& obj, const int pos, const std::string& module) throw(Oracle::Error)
+{
+	define_col(obj.data(), obj.maxsize(), obj.sqlt(), obj.ind_addr(), obj.len_addr(), pos, module);
+}
+
+
+void
+Oracle::Select_Stmt::define_col(void* data, const int width, const int sqlt, sb2* indp, ub2* lenp,
+	const int pos, const std::string& module) throw(Oracle::Error)
+{
+	// The buffer is defined directly unless an array size greater than one has been set;
+	// in that case the column is defined into an array of arr_sz values and each fetched
+	// row is copied into the buffer by load_row().
+	Fetch_Col col;
+	col.dst = (char*) data;
+	col.indp = indp;
+	col.lenp = lenp;
+	col.width = width;
+	col.str = sqlt == SQLT_STR;
+	col.buf = 0;
+	col.ind = 0;
+	col.len = 0;
+	col.buf2 = 0;
+	col.ind2 = 0;
+	col.len2 = 0;
+	col.pos = pos;
+	col.sqlt = sqlt;
+	if (arr_sz > 1)
+	{
+		col.buf = new char[arr_sz * col.width];
+		col.ind = new sb2[arr_sz];
+		col.len = new ub2[arr_sz];
+		if (bg)
+		{
+			col.buf2 = new char[arr_sz * col.width];
+			col.ind2 = new sb2[arr_sz];
+			col.len2 = new ub2[arr_sz];
+		}
+	}
+
+	OCIDefine* def_h = 0;
+	if (OCIDefineByPos(
+			stmt_h,						// stmt handle
+			&def_h,						// define handle returned
+			err_h,						// error handle
+			(ub4) pos,					// position (one-based)
+			col.buf ? (dvoid*) col.buf : (dvoid*) data,	// output buffer
+			(sb4) col.width,				// output buffer size
+			(ub2) sqlt,					// external data type
+			col.ind ? (dvoid*) col.ind : (dvoid*) indp,	// indicator
+			col.len ? col.len : lenp,			// returned length(s)
+			(ub2*) 0,					// array of return codes
+			(ub4) OCI_DEFAULT))
+	{
+		delete [] col.buf;
+		delete [] col.ind;
+		delete [] col.len;
+		delete [] col.buf2;
+		delete [] col.ind2;
+		delete [] col.len2;
+		OCI_Error e(module, err_h);
+		e.desc << "statement = {" << stmt_p << "}; position = " << pos;
+		throw e;
+	}
+	col.def_h = def_h;
+
+	if (col.buf)
+	{
+		// consecutive rows are one value width apart
+		if (OCIDefineArrayOfStruct(
+				def_h,					// define handle
+				err_h,					// error handle
+				(ub4) col.width,			// skip between values
+				(ub4) sizeof(sb2),			// skip between indicators
+				(ub4) sizeof(ub2),			// skip between lengths
+				(ub4) 0))				// skip between return codes
+		{
+			delete [] col.buf;
+			delete [] col.ind;
+			delete [] col.len;
+			delete [] col.buf2;
+			delete [] col.ind2;
+			delete [] col.len2;
+			OCI_Error e(module, err_h);
+			e.desc << "statement = {" << stmt_p << "}; position = " << pos;
+			throw e;
+		}
+		arr_v.push_back(col);
+	}
+
+	// save the define handle
+	def_l.push_back(def_h);
+}
+
+
+void
+Oracle::Select_Stmt::begin_row(const int n) throw(Oracle::Error)
+{
+	// check state
+	if (st == Initialized)
+	{
+		if (std::ostringstream::str().length())
+			prepare(std::ostringstream::str());
+		else
+			throw State_Error("Select_Stmt::bind_row", "No statement text has been specified");
+	}
+	if (st < Executed) // must be executed so we know the # of columns
+		exec();
+	else if (st > Defined || batch_)
+	{
+		State_Error e("Select_Stmt::bind_row", "Too late to bind a column");
+		e.desc << "statement = {" << stmt_p << "}";
+		throw e;
+	}
+
+	// a whole row must supply exactly one host variable per column
+	if (n && (n != nc || def_l.size()))
+	{
+		Value_Error e("Select_Stmt::bind_row", "Number of host variables does not match the select list");
+		e.desc << "statement = {" << stmt_p << "}; columns = " << nc << "; host variables = " << n;
+		throw e;
+	}
+}
+
+
+bool
+Oracle::Select_Stmt::fetch_array() throw(Oracle::Error)
+{
+	// serve the next row of the current block if there is one
+	if (++blk_pos < blk_rows)
+	{
+		load_row(blk_pos);
+		return true;
+	}
+	if (blk_last)
+		return false;
+
+	// fetch the next block of up to arr_sz rows, unless the refill
+	// thread has already been asked to
+	sword rc;
+	OCIError* eh = err_h;
+	if (refill_on)
+	{
+		rc = finish_refill();
+		eh = refill_err_h;
+	}
+	else
+		do
+			rc = OCIStmtFetch(
+				stmt_h,							// stmt handle
+				err_h,							// error handle
+				(ub4) arr_sz,						// #rows to fetch
+				(ub4) OCI_FETCH_NEXT,					// orientation
+				(ub4) OCI_DEFAULT);					// mode
+		while (rc == OCI_STILL_EXECUTING && !async_);
+
+	busy_ = rc == OCI_STILL_EXECUTING;
+	switch (rc)
+	{
+		case OCI_STILL_EXECUTING:
+			return false;
+		case OCI_SUCCESS:
+		case OCI_SUCCESS_WITH_INFO:
+			break;
+		case OCI_NO_DATA:
+			// a short block is still returned along with OCI_NO_DATA
+			blk_last = true;
+			break;
+		default:
+			OCI_Error e("Select_Stmt::fetch()", eh);
+			e.desc << "statement = {" << stmt_p << "}";
+			throw e;
+	}
+
+	// the row count is cumulative, so the block size is the difference
+	ub4 rowcount;
+	if (OCIAttrGet(	(dvoid *) stmt_h,						// statement handle
+			(ub4) OCI_HTYPE_STMT,						// handle type
+			(dvoid *) &rowcount,						// returned value
+			(ub4 *) 0,							// output size (0==default)
+			(ub4) OCI_ATTR_ROW_COUNT,					// attribute to return
+			err_h))								// error handle
+	{
+		OCI_Error e("Select_Stmt::fetch()", err_h);
+		e.desc << "statement = {" << stmt_p << "}";
+		throw e;
+	}
+	blk_rows = (int) rowcount - nfetched;
+	nfetched = (int) rowcount;
+	blk_pos = 0;
+
+	if (blk_rows <= 0)
+		return false;
+	if (bg && !blk_last && arr_v.size() && arr_v[0].buf2)
+		start_refill();
+	load_row(0);
+	st = Fetched;
+	return true;
+}
+
+
+const Oracle::Column_Batch&
+Oracle::Select_Stmt::fetch_batch(const int n) throw(Oracle::Error)
+{
+	// execute statement if not already done
+	if (st < Executed)
+		exec();
+
+	// the batch defines its own columns, so they must not have been bound otherwise
+	if (!batch_ && st > Executed)
+	{
+		State_Error e("Select_Stmt::fetch_batch(const int)", "Columns have already been bound");
+		e.desc << "statement = {" << stmt_p << "}";
+		throw e;
+	}
+	if (n < 1)
+	{
+		Value_Error e("Select_Stmt::fetch_batch(const int)", "Batch size must be at least 1");
+		e.desc << "size = " << n;
+		throw e;
+	}
+
+	// (re)allocate the column arrays and define them if the batch has grown
+	if (!batch_ || n > batch_->capacity())
+	{
+		if (!batch_)
+			batch_ = new Column_Batch;
+		def_l.clear();
+		batch_->init_data(*this, n);
+
+		for (int i=0; i < nc; i++)
+		{
+			Column_Batch::Column& c = batch_->cols[i];
+			ub2 sqlt;
+			switch (c.type)
+			{
+				case Column_Batch::Long:	sqlt = SQLT_INT; break;
+				case Column_Batch::Double:	sqlt = SQLT_FLT; break;
+				case Column_Batch::String:	sqlt = SQLT_CHR; break;
+				default:			sqlt = SQLT_ODT; break;
+			}
+
+			OCIDefine* def_h = 0;
+			if (OCIDefineByPos(
+					stmt_h,					// stmt handle
+					&def_h,					// define handle returned
+					err_h,					// error handle
+					(ub4) i + 1,				// position (one-based)
+					(dvoid*) c.buf,				// output buffer
+					(sb4) c.width,				// size of one value
+					sqlt,					// external data type
+					(dvoid*) c.ind,				// indicators
+					c.len,					// array of length values
+					(ub2*) 0,				// array of return codes
+					(ub4) OCI_DEFAULT)
+			    || OCIDefineArrayOfStruct(
+					def_h,					// define handle
+					err_h,					// error handle
+					(ub4) c.width,				// skip between values
+					(ub4) sizeof(sb2),			// skip between indicators
+					(ub4) sizeof(ub2),			// skip between lengths
+					(ub4) 0))				// skip between return codes
+			{
+				OCI_Error e("Select_Stmt::fetch_batch(const int)", err_h);
+				e.desc << "statement = {" << stmt_p << "}; position = " << i + 1;
+				throw e;
+			}
+			def_l.push_back(def_h);
+		}
+		st = Defined;
+	}
+
+	// nothing more to fetch once OCI has reported the end of the result set
+	if (blk_last)
+	{
+		batch_->finish(0);
+		return *batch_;
+	}
+
+	sword rc;
+	do
+		rc = OCIStmtFetch(
+			stmt_h,								// stmt handle
+			err_h,								// error handle
+			(ub4) n,							// #rows to fetch
+			(ub4) OCI_FETCH_NEXT,						// orientation
+			(ub4) OCI_DEFAULT);						// mode
+	while (rc == OCI_STILL_EXECUTING);
+
+	switch (rc)
+	{
+		case OCI_SUCCESS:
+		case OCI_SUCCESS_WITH_INFO:
+			break;
+		case OCI_NO_DATA:
+			blk_last = true;
+			break;
+		default:
+			OCI_Error e("Select_Stmt::fetch_batch(const int)", err_h);
+			e.desc << "statement = {" << stmt_p << "}";
+			throw e;
+	}
+
+	// the row count is cumulative, so the batch size is the difference
+	ub4 rowcount;
+	if (OCIAttrGet(	(dvoid *) stmt_h,						// statement handle
+			(ub4) OCI_HTYPE_STMT,						// handle type
+			(dvoid *) &rowcount,						// returned value
+			(ub4 *) 0,							// output size (0==default)
+			(ub4) OCI_ATTR_ROW_COUNT,					// attribute to return
+			err_h))								// error handle
+	{
+		OCI_Error e("Select_Stmt::fetch_batch(const int)", err_h);
+		e.desc << "statement = {" << stmt_p << "}";
+		throw e;
+	}
+	batch_->finish((int) rowcount - nfetched);
+	nfetched = (int) rowcount;
+	if (batch_->nrows())
+		st = Fetched;
+	return *batch_;
+}
+
+
+void
+Oracle::Select_Stmt::load_row(const int r) throw()
+{
+	for (int i=0; i < arr_v.size(); i++)
+	{
+		const Fetch_Col& col = arr_v[i];
+		const char* src = col.buf + r * col.width;
+		if (col.str)
+		{
+			// copy only the returned characters and terminate the string
+			int n = col.len[r] < col.width ? col.len[r] : col.width - 1;
+			std::memcpy(col.dst, src, n);
+			col.dst[n] = '\0';
+		}
+		else
+			std::memcpy(col.dst, src, col.width);
+		*col.indp = col.ind[r];
+		if (col.lenp)
+			*col.lenp = col.len[r];
+	}
+}
+
+
+void
+Oracle::Select_Stmt::free_arrays() throw()
+{
+	for (int i=0; i < arr_v.size(); i++)
+	{
+		delete [] arr_v[i].buf;
+		delete [] arr_v[i].ind;
+		delete [] arr_v[i].len;
+		delete [] arr_v[i].buf2;
+		delete [] arr_v[i].ind2;
+		delete [] arr_v[i].len2;
+	}
+	arr_v.clear();
+}
+
+
+void
+Oracle::Select_Stmt::start_refill() throw(Oracle::Error)
+{
+	// Point the defines at the second arrays and fetch into them while
+	// rows are served from the first.  Only the refill thread makes OCI
+	// calls on the statement until finish_refill().
+	for (int i=0; i < arr_v.size(); i++)
+	{
+		Fetch_Col& col = arr_v[i];
+		if (OCIDefineByPos(
+				stmt_h,					// stmt handle
+				&col.def_h,				// existing define handle
+				err_h,					// error handle
+				(ub4) col.pos,				// position (one-based)
+				(dvoid*) col.buf2,			// output buffer
+				(sb4) col.width,			// output buffer size
+				(ub2) col.sqlt,				// external data type
+				(dvoid*) col.ind2,			// indicators
+				col.len2,				// returned lengths
+				(ub2*) 0,				// array of return codes
+				(ub4) OCI_DEFAULT)
+			|| OCIDefineArrayOfStruct(
+				col.def_h,				// define handle
+				err_h,					// error handle
+				(ub4) col.width,			// skip between values
+				(ub4) sizeof(sb2),			// skip between indicators
+				(ub4) sizeof(ub2),			// skip between lengths
+				(ub4) 0))				// skip between return codes
+		{
+			OCI_Error e("Select_Stmt::fetch()", err_h);
+			e.desc << "statement = {" << stmt_p << "}; position = " << col.pos;
+			throw e;
+		}
+	}
+
+	// hand the fetch to the refill thread
+	pthread_mutex_lock(&refill_mtx);
+	refill_on = refill_go = true;
+	pthread_cond_broadcast(&refill_cv);
+	pthread_mutex_unlock(&refill_mtx);
+}
+
+
+void*
+Oracle::Select_Stmt::refill_main(void* arg)
+{
+	// fetch one block per request until told to quit
+	Select_Stmt* s = (Select_Stmt*) arg;
+	pthread_mutex_lock(&s->refill_mtx);
+	for (;;)
+	{
+		while (!s->refill_go && !s->refill_quit)
+			pthread_cond_wait(&s->refill_cv, &s->refill_mtx);
+		if (s->refill_quit)
+			break;
+		pthread_mutex_unlock(&s->refill_mtx);
+
+		sword rc;
+		do
+			rc = OCIStmtFetch(
+				s->stmt_h,						// stmt handle
+				s->refill_err_h,					// error handle
+				(ub4) s->arr_sz,					// #rows to fetch
+				(ub4) OCI_FETCH_NEXT,					// orientation
+				(ub4) OCI_DEFAULT);					// mode
+		while (rc == OCI_STILL_EXECUTING);
+
+		pthread_mutex_lock(&s->refill_mtx);
+		s->refill_rc = rc;
+		s->refill_go = false;
+		pthread_cond_broadcast(&s->refill_cv);
+	}
+	pthread_mutex_unlock(&s->refill_mtx);
+	return 0;
+}
+
+
+int
+Oracle::Select_Stmt::finish_refill() throw()
+{
+	// afterwards the defines point at the first arrays again
+	pthread_mutex_lock(&refill_mtx);
+	while (refill_go)
+		pthread_cond_wait(&refill_cv, &refill_mtx);
+	pthread_mutex_unlock(&refill_mtx);
+	refill_on = false;
+	for (int i=0; i < arr_v.size(); i++)
+	{
+		Fetch_Col& col = arr_v[i];
+		std::swap(col.buf, col.buf2);
+		std::swap(col.ind, col.ind2);
+		std::swap(col.len, col.len2);
+	}
+	return refill_rc;
+}
+
+
+void
+Oracle::Select_Stmt::stop_refill() throw()
+{
+	if (!refill_live)
+		return;
+	if (refill_on)
+		finish_refill();
+
+	pthread_mutex_lock(&refill_mtx);
+	refill_quit = true;
+	pthread_cond_broadcast(&refill_cv);
+	pthread_mutex_unlock(&refill_mtx);
+	pthread_join(refill_thr, 0);
+	refill_live = false;
+
+	pthread_cond_destroy(&refill_cv);
+	pthread_mutex_destroy(&refill_mtx);
+	OCIHandleFree((dvoid *) refill_err_h, (ub4) OCI_HTYPE_ERROR);
+	refill_err_h = 0;
+}
+
+
 void
 Oracle::Select_Stmt::throw_subscript_error(const std::string& module) const throw(Oracle::Error)
 {
@@ -370,6 +991,24 @@ Oracle::Select_Stmt::colname(const int n) const throw(Oracle::Error)
 }
 
 
+Oracle::Col_Handle
+Oracle::Select_Stmt::resolve(const std::string& s) throw(Oracle::Error)
+{
+	// the select list is known once the statement has been executed
+	if (st < Executed)
+		exec();
+
+	int i = cindex_->find(s);
+	if (i < 0)
+	{
+		Value_Error e("Select_Stmt::resolve(const std::string&)", "Column does not exist");
+		e.desc << "statement = {" << stmt_p << "}; column = {" << s << "}";
+		throw e;
+	}
+	return Col_Handle(i);
+}
+
+
 void
 Oracle::Select_Stmt::close() throw()
 {
@@ -377,21 +1016,23 @@ Oracle::Select_Stmt::close() throw()
 	if (st == Closed)
 		return;
 
-	// release Rowtype object if necessary
+	// the refill thread uses the statement handle and the arrays
+	stop_refill();
+	bg = false;
+
+	// release Rowtype and Column_Batch objects if necessary
 	delete row_;
+	delete batch_;
 
 	// release the column name vector 
 	delete cnamev_;
 
-	// clear the define handle list
+	// clear the define handle list and release any fetch arrays
 	def_l.clear();
+	free_arrays();
 
-	// release the column name -> number map
-	if (cnamem_)
-	{
-		cnamem_->clear();
-		delete cnamem_;
-	}
+	// release the column name -> number index
+	delete cindex_;
 
 	// release inherited objects; update state
 	Stmt::close();
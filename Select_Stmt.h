@@ -24,8 +24,13 @@
 
 #include "Stmt.h"
 #include "Rowtype.h"
+#include "Nullable.h"
+#include "Column_Batch.h"
+#include "Field.h"
 #include <vector>
-#include <map>
+#include <iterator>
+#include <cstddef>
+#include <pthread.h>
 
 class OCIDefine;
 
@@ -37,6 +42,40 @@ namespace Oracle
 	class Select_Stmt: public Stmt
 	{
 		public:
+			// types
+			class iterator							// input iterator over result rows
+			{
+				public:
+					typedef std::input_iterator_tag iterator_category;
+					typedef Rowtype value_type;
+					typedef std::ptrdiff_t difference_type;
+					typedef Rowtype* pointer;
+					typedef Rowtype& reference;
+
+					iterator()				throw()		// end of results
+						: stmt(0) {}
+					Rowtype& operator*() const		throw()		// current row
+						{ return *stmt->row_; }
+					Rowtype* operator->() const		throw()		// current row
+						{ return stmt->row_; }
+					iterator& operator++()			throw(Error)	// fetch next row
+						{ if (!stmt->fetch()) stmt = 0; return *this; }
+					void operator++(int)			throw(Error)	// fetch next row
+						{ ++*this; }
+					bool operator==(const iterator& i) const throw()
+						{ return stmt == i.stmt; }
+					bool operator!=(const iterator& i) const throw()
+						{ return stmt != i.stmt; }
+
+				protected:
+					explicit iterator(Select_Stmt* s)	throw()
+						: stmt(s) {}
+
+					Select_Stmt* stmt;					// 0 at end
+
+				friend class Select_Stmt;
+			};
+
 			// constructors/destructor
 			Select_Stmt(Connection&)			throw(Error);	// use this Connection
 			Select_Stmt(
@@ -51,12 +90,64 @@ namespace Oracle
 			virtual void bind_col(Rowtype&)			throw(Error);
 			virtual bool fetch()				throw(Error);	// get rows
 			virtual void close()				throw();
+			virtual void reset()				throw(Error);	// ready to execute again, keeping defines
+			void set_array_size(const int)			throw(Error);	// rows per round trip
+			void auto_prefetch(const int = 65536)		throw(Error);	// size prefetch from row width
+			void set_row_layout(const Rowtype::layout_t)	throw(Error);	// layout of fetch()'s internal row
+			void set_background_fetch(const bool)		throw(Error);	// fetch next array block in a thread
+			const Column_Batch& fetch_batch(const int)	throw(Error);	// get rows column by column
+			Pending fetch_async()				throw(Error);	// start fetch(), poll for completion
+			iterator begin()				throw(Error);	// fetch first row
+			iterator end()					throw()		// past last row
+				{ return iterator(); }
+
+			// typed binding: bind_row() defines one Field, Char_Field or Date_Field
+			// per column and checks that the number of columns matches
+			template <class T> void define(Field<T>& f)	throw(Error)	// define next column
+				{ begin_row(0); define_col(&f.val, Field_Traits<T>::size, Field_Traits<T>::sqlt,
+					&f.ind, &f.len, def_l.size() + 1, "Select_Stmt::define(Field&)"); st = Defined; }
+			template <int N> void define(Char_Field<N>& f)	throw(Error)	// define next column
+				{ begin_row(0); define_col(f.buf, N, 1, &f.ind, &f.len,		// SQLT_CHR
+					def_l.size() + 1, "Select_Stmt::define(Char_Field&)"); st = Defined; }
+			void define(Date_Field& f)			throw(Error)	// define next column
+				{ begin_row(0); define_col(f.d, sizeof(f.d), 12, &f.ind, &f.len,	// SQLT_DAT
+					def_l.size() + 1, "Select_Stmt::define(Date_Field&)"); st = Defined; }
+			template <class A>
+			void bind_row(A& a) throw(Error)
+				{ begin_row(1); define(a); }
+			template <class A, class B>
+			void bind_row(A& a, B& b) throw(Error)
+				{ begin_row(2); define(a); define(b); }
+			template <class A, class B, class C>
+			void bind_row(A& a, B& b, C& c) throw(Error)
+				{ begin_row(3); define(a); define(b); define(c); }
+			template <class A, class B, class C, class D>
+			void bind_row(A& a, B& b, C& c, D& d) throw(Error)
+				{ begin_row(4); define(a); define(b); define(c); define(d); }
+			template <class A, class B, class C, class D, class E>
+			void bind_row(A& a, B& b, C& c, D& d, E& e) throw(Error)
+				{ begin_row(5); define(a); define(b); define(c); define(d); define(e); }
+			template <class A, class B, class C, class D, class E, class F>
+			void bind_row(A& a, B& b, C& c, D& d, E& e, F& f) throw(Error)
+				{ begin_row(6); define(a); define(b); define(c); define(d); define(e); define(f); }
+			template <class A, class B, class C, class D, class E, class F, class G>
+			void bind_row(A& a, B& b, C& c, D& d, E& e, F& f, G& g) throw(Error)
+				{ begin_row(7); define(a); define(b); define(c); define(d); define(e); define(f); define(g); }
+			template <class A, class B, class C, class D, class E, class F, class G, class H>
+			void bind_row(A& a, B& b, C& c, D& d, E& e, F& f, G& g, H& h) throw(Error)
+				{ begin_row(8); define(a); define(b); define(c); define(d); define(e); define(f); define(g); define(h); }
 			inline Nullable& operator[](const int i)	throw(Error)	// get column data
 				{ if (row_) return (*row_)[i];
 				else throw_subscript_error("Select_Stmt::operator[](const int)"); }
 			inline Nullable& operator[](const std::string& s) throw(Error)	// get column data
 				{ if (row_) return (*row_)[s];
 				else throw_subscript_error("Select_Stmt::operator[](const std::string&)"); }
+			inline Nullable& operator[](const char* s)	throw(Error)	// get column data
+				{ if (row_) return (*row_)[s];
+				else throw_subscript_error("Select_Stmt::operator[](const char*)"); }
+			inline Nullable& operator[](const Col_Handle h)	throw(Error)	// get column data
+				{ if (row_) return (*row_)[h];
+				else throw_subscript_error("Select_Stmt::operator[](const Col_Handle)"); }
 
 			// accessors
 			const inline Nullable& operator[](const int i) const throw(Error) // get column data
@@ -65,13 +156,41 @@ namespace Oracle
 			const inline Nullable& operator[](const std::string& s) const throw(Error) // get column data
 				{ if (row_) return (*row_)[s];
 				else throw_subscript_error("Select_Stmt::operator[](const std::string&)"); }
+			const inline Nullable& operator[](const char* s) const throw(Error) // get column data
+				{ if (row_) return (*row_)[s];
+				else throw_subscript_error("Select_Stmt::operator[](const char*)"); }
+			const inline Nullable& operator[](const Col_Handle h) const throw(Error) // get column data
+				{ if (row_) return (*row_)[h];
+				else throw_subscript_error("Select_Stmt::operator[](const Col_Handle)"); }
+			Col_Handle resolve(const std::string&)		throw(Error);	// look up a column once
 			virtual std::string colname(const int) const	throw(Error);	// get column name
 			virtual stmt_t type() const					// statement type
 				{ return Select; }
 			virtual int ncols() const					// number of columns
 				{ return nc; }
+			int array_size() const				throw()		// rows per round trip
+				{ return arr_sz; }
 
 		protected:
+			// types
+			struct Fetch_Col						// fetch array for one column
+			{
+				char* dst;						// value served from array
+				sb2* indp;						// indicator served from array
+				ub2* lenp;						// length served from array
+				char* buf;						// array of values
+				sb2* ind;						// array of null indicators
+				ub2* len;						// array of value lengths
+				int width;						// size of one value
+				bool str;						// null-terminated string
+				char* buf2;						// second arrays for background fetch
+				sb2* ind2;
+				ub2* len2;
+				OCIDefine* def_h;					// define handle
+				int pos;						// position (one-based)
+				int sqlt;						// external data type
+			};
+
 			// protected constructors
 			Select_Stmt()					throw(Error);
 			Select_Stmt(
@@ -83,16 +202,56 @@ namespace Oracle
 			// protected implementors
 			void throw_subscript_error(const std::string&) const throw(Error);
 			void get_column_info() throw(Error);
+			void define_col(Nullable&, const int, const std::string&) throw(Error);
+			void define_col(						// define a host buffer
+				void*,							// value
+				const int,						// size of value
+				const int,						// external data type
+				sb2*,							// null indicator
+				ub2*,							// returned length
+				const int,						// position (one-based)
+				const std::string&)			throw(Error);	// calling function
+			void begin_row(const int)			throw(Error);	// validate state (and column count)
+			bool fetch_array()				throw(Error);	// serve rows from fetch arrays
+			void load_row(const int)			throw();	// copy array row to objects
+			void free_arrays()				throw();
+			void start_refill()				throw(Error);	// fetch next block into second arrays
+			int finish_refill()				throw();	// wait for it, swap arrays, return OCI status
+			void stop_refill()				throw();	// end refill thread, free its handle
+			static void* refill_main(void*);			// refill thread body
 			
 			// data members
 			int nc;								// number of columns returned
 			Rowtype* row_;
 			std::list<OCIDefine*> def_l;					// list of define handles
 			std::vector<std::string>* cnamev_;				// vector of column names
-			std::map<std::string, int>* cnamem_;				// map of col name to number
+			Name_Index* cindex_;						// col name -> number
+			int arr_sz;							// rows per OCIStmtFetch
+			std::vector<Fetch_Col> arr_v;					// fetch arrays, one per column
+			int blk_rows;							// rows in current fetch block
+			int blk_pos;							// current row in fetch block
+			int nfetched;							// rows fetched since execute
+			bool blk_last;							// no more rows after this block
+			int pf_auto;							// prefetch memory budget (0==off)
+			Rowtype::layout_t row_lay;					// layout of row_
+			bool bg;							// background fetch requested
+			OCIError* refill_err_h;						// refill thread's error handle
+			bool refill_on;							// a block is being fetched into the second arrays
+			bool refill_live;						// refill thread is running
+			pthread_t refill_thr;						// refill thread
+			pthread_mutex_t refill_mtx;					// guards refill_go, refill_quit, refill_rc
+			pthread_cond_t refill_cv;					// a request was made or finished
+			bool refill_go;							// a fetch is requested or in progress
+			bool refill_quit;						// refill thread should exit
+			int refill_rc;							// refill thread's OCI status
+			static const int default_iter_array = 100;			// begin()'s default array size
+			Column_Batch* batch_;						// columns for fetch_batch()
 
 		friend class Connection;
 		friend class Rowtype;
+		friend class Column_Batch;
+		friend class Parallel_Select;
+		friend class Copy_Pipeline;
 	};
 }
 
@@ -23,17 +23,22 @@
 #include "Connection.h"
 #include "Nullable.h"
 #include "Rowtype.h"
+#include "Nullable_Array.h"
+#include "Select_Stmt.h"
 #include <oci.h>
+#include <sched.h>
 
 
 Oracle::Stmt::Stmt() throw(Oracle::Error)
-	: svc_h(0), err_h(0), st(Initialized), stmt_p(0)
+	: svc_h(0), err_h(0), st(Initialized), stmt_p(0), db_(0), cached(false), arr_rows(0),
+	  async_(false), busy_(false)
 {
 }
 
 
 Oracle::Stmt::Stmt(Connection& db) throw(Oracle::Error)
-	: svc_h(db.svc_handle()), err_h(db.err_handle()), st(Initialized), stmt_p(0)
+	: svc_h(db.svc_handle()), err_h(db.err_handle()), st(Initialized), stmt_p(0), db_(&db), cached(false), arr_rows(0),
+	  async_(false), busy_(false)
 {
 	// connect to database if necessary and set handles again
 	if (db.stat == Connection::not_connected)
@@ -51,11 +56,16 @@ Oracle::Stmt::Stmt(Connection& db) throw(Oracle::Error)
 			(size_t) 0,							// user-def memory size
 			(dvoid **) 0))							// user-def memory ptr
 		throw Error("Stmt::alloc_stmt_hdl()", "OCIHandleAlloc failed for statement");
+
+	// apply the connection's default prefetch settings
+	db.apply_prefetch(stmt_h);
 }
 
 
 Oracle::Stmt::Stmt(Connection& db, const std::string& sql) throw(Oracle::Error)
-	: svc_h(db.svc_handle()), err_h(db.err_handle()), st(Initialized), stmt_p(new char[sql.length() + 1])
+	: svc_h(db.svc_handle()), err_h(db.err_handle()), st(Initialized), stmt_p(new char[sql.length() + 1]),
+	  db_(&db), cached(false), arr_rows(0),
+	  async_(false), busy_(false)
 {
 	// connect to database if necessary and set handles again
 	if (db.stat == Connection::not_connected)
@@ -74,12 +84,16 @@ Oracle::Stmt::Stmt(Connection& db, const std::string& sql) throw(Oracle::Error)
 			(dvoid **) 0))							// user-def memory ptr
 		throw Error("Stmt::Stmt(Connection&, const std::string&)", "OCIHandleAlloc failed for statement");
 
+	// apply the connection's default prefetch settings
+	db.apply_prefetch(stmt_h);
+
 	prepare(sql);
 }
 
 
 Oracle::Stmt::Stmt(OCIStmt* stmt_hdl, char* stmt_ptr, OCISvcCtx* svc_hdl, OCIError* err_hdl) throw()
-	: stmt_h(stmt_hdl), stmt_p(stmt_ptr), svc_h(svc_hdl), err_h(err_hdl), st(Prepared)
+	: stmt_h(stmt_hdl), stmt_p(stmt_ptr), svc_h(svc_hdl), err_h(err_hdl), st(Prepared), db_(0), cached(false), arr_rows(0),
+	  async_(false), busy_(false)
 {
 }
 
@@ -114,8 +128,22 @@ Oracle::Stmt::prepare(const std::string& sql) throw(Oracle::Error)
 	sql.copy(stmt_p, sql.length());
 	stmt_p[sql.length()] = '\0';
 
+	if (db_ && db_->stmt_cache_size())
+	{
+		// swap the handle allocated by the constructor for one from the
+		// statement cache, carrying over its prefetch settings
+		int pf_rows = prefetch_rows();
+		int pf_mem = prefetch_memory();
+		OCIHandleFree((dvoid *)stmt_h, (ub4)OCI_HTYPE_STMT);
+		stmt_h = 0;
+		stmt_h = db_->prepare_cached(stmt_p, "Stmt::prepare(const std::string&)");
+		cached = true;
+		set_prefetch_rows(pf_rows);
+		set_prefetch_memory(pf_mem);
+	}
+
 	// prepare the statement
-	if(OCIStmtPrepare(
+	else if(OCIStmtPrepare(
 			stmt_h,								// statement handle
 			err_h,								// error handle
 			(text *) stmt_p,						// statement text
@@ -205,6 +233,86 @@ Oracle::Stmt::nrows() const throw(Oracle::Error)
 }
 
 
+void
+Oracle::Stmt::set_prefetch_rows(const int n) throw(Oracle::Error)
+{
+	ub4 rows(n);
+	if(OCIAttrSet(	(dvoid *) stmt_h,						// statement handle
+			(ub4) OCI_HTYPE_STMT,						// handle type
+			(dvoid *) &rows,						// rows to prefetch
+			(ub4) 0,							// size of attribute
+			(ub4) OCI_ATTR_PREFETCH_ROWS,					// attribute to set
+			err_h))								// error handle
+	{
+		OCI_Error e("Stmt::set_prefetch_rows(const int)", err_h);
+		e.desc << "rows = " << n;
+		if (stmt_p)
+			e.desc << "; statement = {" << stmt_p << "}";
+		throw e;
+	}
+}
+
+
+void
+Oracle::Stmt::set_prefetch_memory(const int n) throw(Oracle::Error)
+{
+	ub4 mem(n);
+	if(OCIAttrSet(	(dvoid *) stmt_h,						// statement handle
+			(ub4) OCI_HTYPE_STMT,						// handle type
+			(dvoid *) &mem,							// bytes to prefetch
+			(ub4) 0,							// size of attribute
+			(ub4) OCI_ATTR_PREFETCH_MEMORY,					// attribute to set
+			err_h))								// error handle
+	{
+		OCI_Error e("Stmt::set_prefetch_memory(const int)", err_h);
+		e.desc << "memory = " << n;
+		if (stmt_p)
+			e.desc << "; statement = {" << stmt_p << "}";
+		throw e;
+	}
+}
+
+
+int
+Oracle::Stmt::prefetch_rows() const throw(Oracle::Error)
+{
+	ub4 rows;
+	if(OCIAttrGet(	(dvoid *) stmt_h,						// statement handle
+			(ub4) OCI_HTYPE_STMT,						// handle type
+			(dvoid *) &rows,						// returned value
+			(ub4 *) 0,							// output size (0==default)
+			(ub4) OCI_ATTR_PREFETCH_ROWS,					// attribute to return
+			err_h))								// error handle
+	{
+		OCI_Error e("Stmt::prefetch_rows()", err_h);
+		if (stmt_p)
+			e.desc << "statement = {" << stmt_p << "}";
+		throw e;
+	}
+	return (int)rows;
+}
+
+
+int
+Oracle::Stmt::prefetch_memory() const throw(Oracle::Error)
+{
+	ub4 mem;
+	if(OCIAttrGet(	(dvoid *) stmt_h,						// statement handle
+			(ub4) OCI_HTYPE_STMT,						// handle type
+			(dvoid *) &mem,							// returned value
+			(ub4 *) 0,							// output size (0==default)
+			(ub4) OCI_ATTR_PREFETCH_MEMORY,					// attribute to return
+			err_h))								// error handle
+	{
+		OCI_Error e("Stmt::prefetch_memory()", err_h);
+		if (stmt_p)
+			e.desc << "statement = {" << stmt_p << "}";
+		throw e;
+	}
+	return (int)mem;
+}
+
+
 std::string
 Oracle::Stmt::str() const throw()
 {
@@ -244,7 +352,7 @@ Oracle::Stmt::bind(Nullable& bindvar) throw(Oracle::Error)
 			(sb4) bindvar.maxsize(),
 			(ub2) bindvar.sqlt(),
 			(dvoid*) bindvar.ind_addr(),
-			(ub2*) 0,
+			(ub2*) bindvar.len_addr(),
 			(ub2*) 0,
 			(ub4) 0,
 			(ub4*) 0,
@@ -257,6 +365,12 @@ Oracle::Stmt::bind(Nullable& bindvar) throw(Oracle::Error)
 		throw e;
 	}
 
+	// remember the bind
+	Bind_Var b;
+	b.var = &bindvar;
+	b.pos = bind_l.size() + 1;
+	bind_v.push_back(b);
+
 	// add the bind handle to the list
 	bind_l.push_back(bind_h);
 }
@@ -293,7 +407,7 @@ Oracle::Stmt::bind(Nullable& bindvar, const std::string& label) throw(Oracle::Er
 			(sb4) bindvar.maxsize(),
 			(ub2) bindvar.sqlt(),
 			(dvoid*) bindvar.ind_addr(),
-			(ub2*) 0,
+			(ub2*) bindvar.len_addr(),
 			(ub2*) 0,
 			(ub4) 0,
 			(ub4*) 0,
@@ -305,6 +419,106 @@ Oracle::Stmt::bind(Nullable& bindvar, const std::string& label) throw(Oracle::Er
 			e.desc << "; statement = {" << stmt_p << "}";
 		throw e;
 	}
+
+	// remember the bind
+	Bind_Var b;
+	b.var = &bindvar;
+	b.name = label;
+	b.pos = 0;
+	bind_v.push_back(b);
+
+	// add the bind handle to the list
+	bind_l.push_back(bind_h);
+}
+
+
+void
+Oracle::Stmt::bind(Nullable_Array& arr) throw(Oracle::Error)
+{
+	bind_array(arr, "", "Stmt::bind(Nullable_Array&)");
+}
+
+
+void
+Oracle::Stmt::bind(Nullable_Array& arr, const std::string& label) throw(Oracle::Error)
+{
+	bind_array(arr, label, "Stmt::bind(Nullable_Array&, const std::string&)");
+}
+
+
+void
+Oracle::Stmt::bind_array(Nullable_Array& arr, const std::string& label, const std::string& module) throw(Oracle::Error)
+{
+	// check state
+	if (st == Initialized)
+	{
+		if (std::ostringstream::str().length())
+			prepare(std::ostringstream::str());
+		else
+			throw State_Error(module, "No statement text has been specified");
+	}
+	else if (st > Prepared)
+	{
+		State_Error e(module, "Cannot bind after execution");
+		e.desc << "position = " << bind_l.size() + 1;
+		if (stmt_p)
+			e.desc << "; statement = {" << stmt_p << "}";
+		throw e;
+	}
+
+	// do the bind
+	OCIBind* bind_h = 0;
+	sword rc;
+	if (label.empty())
+		rc = OCIBindByPos(stmt_h,
+				&bind_h,
+				err_h,
+				(ub4) bind_l.size() + 1,
+				(dvoid*) arr.data(),
+				(sb4) arr.width(),
+				(ub2) arr.sqlt(),
+				(dvoid*) arr.ind,
+				(ub2*) arr.len,
+				(ub2*) 0,
+				(ub4) 0,
+				(ub4*) 0,
+				OCI_DEFAULT);
+	else
+		rc = OCIBindByName(stmt_h,
+				&bind_h,
+				err_h,
+				(CONST text*) label.c_str(),
+				(sb4) label.length(),
+				(dvoid*) arr.data(),
+				(sb4) arr.width(),
+				(ub2) arr.sqlt(),
+				(dvoid*) arr.ind,
+				(ub2*) arr.len,
+				(ub2*) 0,
+				(ub4) 0,
+				(ub4*) 0,
+				OCI_DEFAULT);
+
+	// each element of value, indicator and length follows the previous one
+	if (rc || OCIBindArrayOfStruct(
+			bind_h,								// bind handle
+			err_h,								// error handle
+			(ub4) arr.width(),						// value skip
+			(ub4) sizeof(sb2),						// indicator skip
+			(ub4) sizeof(ub2),						// length skip
+			(ub4) 0))							// return code skip
+	{
+		OCI_Error e(module, err_h);
+		e.desc << "position = " << bind_l.size() + 1;
+		if (stmt_p)
+			e.desc << "; statement = {" << stmt_p << "}";
+		throw e;
+	}
+
+	// add the bind handle to the list
+	bind_l.push_back(bind_h);
+	if (!arr_rows || arr.size() < arr_rows)
+		arr_rows = arr.size();
 }
 
 
@@ -357,8 +571,8 @@ Oracle::Stmt::bind_q(Rowtype& row) throw(Oracle::Error)
 }
 
 
-void
-Oracle::Stmt::do_exec(const int iters) throw(Oracle::Error)
+bool
+Oracle::Stmt::do_exec(const int iters, const unsigned mode) throw(Oracle::Error)
 {
 	// The parameter indicates the following:
 	// 	For SELECT statements, if iters is non-zero, then defines must have already been done,
@@ -382,8 +596,11 @@ Oracle::Stmt::do_exec(const int iters) throw(Oracle::Error)
 		throw e;
 	}
 
-	// execute statement
-	switch(OCIStmtExecute(
+	// execute statement; in non-blocking mode the same call is repeated
+	// until it completes, here or (for exec_async()) from Pending::poll()
+	sword rc;
+	do
+		rc = OCIStmtExecute(
 			svc_h,									// service handle
 			stmt_h,									// statement handle
 			err_h,									// error handle
@@ -391,8 +608,15 @@ Oracle::Stmt::do_exec(const int iters) throw(Oracle::Error)
 			(ub4) 0,								// offset into bind array
 			(OCISnapshot*) 0,							// input snapshot
 			(OCISnapshot*) 0,							// output snapshot
-			(ub4) OCI_DEFAULT))							// mode
+			(ub4) OCI_DEFAULT | mode);						// mode
+	while (rc == OCI_STILL_EXECUTING && !async_);
+
+	busy_ = rc == OCI_STILL_EXECUTING;
+	switch (rc)
 	{
+		case OCI_STILL_EXECUTING:
+			return false;
+
 		case OCI_SUCCESS:
 		case OCI_SUCCESS_WITH_INFO:
 		case OCI_NO_DATA:
@@ -400,12 +624,104 @@ Oracle::Stmt::do_exec(const int iters) throw(Oracle::Error)
 				st = Executed;
 			break;
 
+		case OCI_ERROR:
+			// with OCI_BATCH_ERRORS, ORA-24381 only says that some rows
+			// were rejected; the caller collects them
+			if (mode & OCI_BATCH_ERRORS)
+			{
+				sb4 code = 0;
+				text msg[512];
+				OCIErrorGet((dvoid *) err_h,				// error handle
+						(ub4) 1,				// record number
+						(text *) 0,				// reserved
+						&code,					// error code
+						msg,					// error message
+						(ub4) sizeof(msg),			// size of error msg buffer
+						(ub4) OCI_HTYPE_ERROR);			// handle type
+				if (code == 24381)
+				{
+					if (st < Executed)
+						st = Executed;
+					break;
+				}
+			}
+			// fall through
+
 		default:
 			OCI_Error e("Stmt::do_exec", err_h);
 			if (stmt_p)
 				e.desc << "statement = {" << stmt_p << "}";
 			throw e;
 	}
+	return true;
+}
+
+
+Oracle::Pending
+Oracle::Stmt::exec_async() throw(Oracle::Error)
+{
+	Pending p(*this, Pending::Exec);
+	p.poll();
+	return p;
+}
+
+
+Oracle::Pending::Pending(Stmt& s, const op_t o) throw()
+	: stmt_(&s), op_(o), done_(false), row_(false)
+{
+}
+
+
+bool
+Oracle::Pending::poll() throw(Oracle::Error)
+{
+	if (done_)
+		return true;
+
+	// calling exec() or fetch() again repeats the OCI call in progress
+	stmt_->async_ = true;
+	try
+	{
+		if (op_ == Exec)
+			stmt_->exec();
+		else
+			row_ = dynamic_cast<Select_Stmt&>(*stmt_).fetch();
+	}
+	catch (Error&)
+	{
+		stmt_->async_ = stmt_->busy_ = false;
+		done_ = true;
+		throw;
+	}
+	stmt_->async_ = false;
+	done_ = !stmt_->busy_;
+	return done_;
+}
+
+
+void
+Oracle::Pending::wait() throw(Oracle::Error)
+{
+	while (!poll())
+		sched_yield();
+}
+
+
+void
+Oracle::Stmt::reset() throw(Oracle::Error)
+{
+	// Bind and define handles stay attached to the statement handle and
+	// read from the same buffers, so running the statement again only
+	// needs another execute.
+	if (st == Closed || st == Invalid)
+	{
+		State_Error e("Stmt::reset()", "Statement is closed");
+		if (stmt_p)
+			e.desc << "statement = {" << stmt_p << "}";
+		throw e;
+	}
+	if (st > Prepared)
+		st = Prepared;
 }
 
 
@@ -418,14 +734,34 @@ Oracle::Stmt::close() throw()
 
 	// clear the bind list
 	bind_l.clear();
+	bind_v.clear();
 
 	// release the statement text
 	delete stmt_p;
 	
 	// release the statement handle
-	if (stmt_h)
-		OCIHandleFree((dvoid *)stmt_h, (ub4)OCI_HTYPE_STMT);
+	free_handle();
 
 	// set the state
 	st = Closed;
 }
+
+
+void
+Oracle::Stmt::free_handle() throw()
+{
+	if (!stmt_h)
+		return;
+
+	// a cached handle goes back to the statement cache for reuse
+	if (cached)
+		OCIStmtRelease(
+				stmt_h,							// statement handle
+				err_h,							// error handle
+				(CONST text *) 0,					// tag
+				(ub4) 0,						// tag length
+				(ub4) OCI_DEFAULT);					// mode
+	else
+		OCIHandleFree((dvoid *)stmt_h, (ub4)OCI_HTYPE_STMT);
+	stmt_h = 0;
+}
@@ -26,6 +26,7 @@
 #include <sstream>
 #include <list>
 #include <queue>
+#include <vector>
 
 class OCIEnv;
 class OCISvcCtx;
@@ -38,11 +39,50 @@ namespace Oracle
 {
 	class Connection;
 	class Nullable;
+	class Nullable_Array;
 	class Rowtype;
 	class Stmt;
 	class Cursor;
 	const char stmt_idx[] = { 106, 101, 99, 97, 105, 110, 0 };
 
+	// Poll handle for a call started with exec_async() or fetch_async().
+	// On a Connection in non-blocking mode, each poll() gives OCI a chance
+	// to make progress and returns true once the call has completed; in
+	// blocking mode the call has already completed when the handle is
+	// returned.  No other call may be made on the statement until then.
+	class Pending
+	{
+		public:
+			// types
+			enum op_t { Exec, Fetch };
+
+			// constructors/destructor
+			Pending(Stmt&, const op_t)			throw();
+			~Pending()					throw()
+				{}
+
+			// implementors
+			bool poll()					throw(Error);	// try to finish, true if done
+			void wait()					throw(Error);	// poll until done
+
+			// accessors
+			bool done() const				throw()		// call has completed
+				{ return done_; }
+			bool row() const				throw()		// Fetch: a row was fetched
+				{ return row_; }
+			op_t op() const					throw()		// call in progress
+				{ return op_; }
+			Stmt& stmt() const				throw()		// statement
+				{ return *stmt_; }
+
+		protected:
+			// data members
+			Stmt* stmt_;
+			op_t op_;
+			bool done_;
+			bool row_;
+	};
+
 	struct Stmt_Null_Manip
 	{
 		// constructor/destructor
@@ -71,6 +111,12 @@ namespace Oracle
 			// types
 			enum stmt_t { Unknown, Select, Non_Select };
 			enum state_t { Invalid, Closed, Initialized, Prepared, Executed, Defined, Fetched };
+			struct Bind_Var							// a scalar bind
+			{
+				Nullable* var;						// bound object
+				std::string name;					// placeholder ("" if by pos)
+				int pos;						// position (one-based)
+			};
 
 			// constructors/destructor
 			virtual ~Stmt()					throw();
@@ -80,13 +126,21 @@ namespace Oracle
 			virtual void prepare(const std::string&)	throw(Error);	// prepare specified text
 			virtual void bind(Nullable&)			throw(Error);	// bind by pos
 			virtual void bind(Nullable&, const std::string&) throw(Error);	// bind by name
+			virtual void bind(Nullable_Array&)		throw(Error);	// bind array by pos
+			virtual void bind(Nullable_Array&, const std::string&) throw(Error); // bind array by name
 			virtual void bind_q(Nullable&)			throw(Error);	// add placeholder
 			virtual void bind_q(Rowtype&)			throw(Error);	// add placeholder
 			virtual void exec() 				throw(Error)= 0; // execute
 			virtual void close()				throw();	// release resources
+			virtual void reset()				throw(Error);	// ready to execute again, keeping binds
+			Pending exec_async()				throw(Error);	// start exec(), poll for completion
+			void set_prefetch_rows(const int)		throw(Error);	// rows prefetched per round trip
+			void set_prefetch_memory(const int)		throw(Error);	// bytes prefetched per round trip
 
 			// accessors
-			int nrows() const				throw(Error);	// returns #rows affected
+			virtual int nrows() const			throw(Error);	// returns #rows affected
+			int prefetch_rows() const			throw(Error);	// effective prefetch rows
+			int prefetch_memory() const			throw(Error);	// effective prefetch memory
 			std::string str() const				throw();	// statement text
 			state_t state() const				throw()		// state
 				{ return st; }
@@ -111,7 +165,14 @@ namespace Oracle
 				{ return err_h; }
 
 			// internal functions
-			void do_exec(const int iter)			throw(Error);	// execute statement
+			bool do_exec(							// execute statement, false if still executing
+				const int iter,						// iterations
+				const unsigned = 0)			throw(Error);	// extra OCI mode flags
+			void free_handle()				throw();	// free or release stmt_h
+			void bind_array(						// bind array by pos or name
+				Nullable_Array&,					// array
+				const std::string&,					// name ("" to bind by pos)
+				const std::string&)			throw(Error);	// calling function
 
 			// data members
 			state_t st;							// state
@@ -121,8 +182,19 @@ namespace Oracle
 			OCIError* err_h;						// error handle
 			std::list<OCIBind*> bind_l;					// list of bind variables
 			std::queue<Nullable*> bind_q_;					// queue of objects to bind
-
+			std::vector<Bind_Var> bind_v;					// scalar binds, in order
+			Connection* db_;						// owning connection (may be 0)
+			bool cached;							// stmt_h belongs to the statement cache
+			int arr_rows;							// smallest bound array (0==none)
+			bool async_;							// caller polls; don't wait for OCI
+			bool busy_;							// an OCI call is still executing
+
+		friend class Connection;
+		friend class Copy_Pipeline;
+		friend class Pending;
+		friend class Reactor;
 		friend class Rowtype;
+		friend class Column_Batch;
 		friend std::ostream& operator<<(std::ostream& s, const Stmt_Null_Manip& m)
 			{ return m.func(s, m.obj); }
 		friend std::ostream& operator<<(std::ostream& s, const Stmt_Row_Manip& m)
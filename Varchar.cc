@@ -29,29 +29,30 @@
 
 
 Oracle::Varchar::Varchar() throw()
-	: Nullable(), vc(0), max_sz(0)
+	: Nullable(), vc(0), max_sz(0), len(0), ext(false)
 {
 }
 
 
 Oracle::Varchar::Varchar(const int n) throw()
-	: Nullable(), vc(new char[n + 1]), max_sz(n + 1)
+	: Nullable(), vc(new char[n + 1]), max_sz(n + 1), len(0), ext(false)
 {
 	*vc = 0;
 }
 
 
 Oracle::Varchar::Varchar(const char* s) throw()
-	: Nullable(), vc(new char[std::strlen(s) + 1]), max_sz(std::strlen(s) + 1)
+	: Nullable(), vc(0), max_sz(std::strlen(s) + 1), len(max_sz), ext(false)
 {
-	// copy s into new array of same size
-	std::strcpy(vc, s);
+	// copy s (and its terminator) into new array of same size
+	vc = new char[max_sz];
+	std::memcpy(vc, s, max_sz);
 	ind = 0;
 }
 
 
 Oracle::Varchar::Varchar(const std::string& s) throw()
-	: Nullable(), vc(new char[s.length() + 1]), max_sz(s.length() + 1)
+	: Nullable(), vc(new char[s.length() + 1]), max_sz(s.length() + 1), len(max_sz), ext(false)
 {
 	// copy into new array of same size
 	s.copy(vc, s.length());
@@ -61,22 +62,31 @@ Oracle::Varchar::Varchar(const std::string& s) throw()
 
 
 Oracle::Varchar::Varchar(const Oracle::Varchar& v) throw()
-	: Nullable()
+	: Nullable(), vc(0), max_sz(0), len(0), ext(false)
 {
 	// if v is not null, initialize this Varchar with v's string
 	if ((ind = v.ind) == 0)
 	{
-		vc = new char[strlen(v.vc) + 1];
-		strcpy(vc, v.vc);
-		max_sz = strlen(v.vc) + 1;
+		int n = v.length();
+		vc = new char[n + 1];
+		std::memcpy(vc, v.vc, n);
+		vc[n] = 0;
+		max_sz = len = n + 1;
 	}
 }
 
 
+Oracle::Varchar::Varchar(char* buf, const int n) throw()
+	: Nullable(), vc(buf), max_sz(n + 1), len(0), ext(true)
+{
+	*vc = 0;
+}
+
+
 Oracle::Varchar::~Varchar() throw()
 {
 	// free any space that was allocated
-	if (vc)
+	if (vc && !ext)
 		delete [] vc;
 	max_sz = 0;
 	ind = -1;
@@ -96,7 +106,7 @@ Oracle::Varchar::str() const throw(Oracle::Error)
 {
 	if (ind == -1)
 		return Nullable::str();
-	return std::string(vc);
+	return std::string(vc, length());
 }
 
 
@@ -105,7 +115,7 @@ Oracle::Varchar::str(const std::string& s) const throw()
 {
 	if (ind == -1)
 		return s;
-	return std::string(vc);
+	return std::string(vc, length());
 }
 
 
@@ -115,7 +125,7 @@ Oracle::Varchar::str(const std::string& s, const std::string& f) const throw()
 	// ignore format
 	if (ind == -1)
 		return s;
-	return std::string(vc);
+	return std::string(vc, length());
 }
 
 
@@ -128,6 +138,26 @@ Oracle::Varchar::sql_str() const throw()
 }
 
 
+Oracle::Str_View
+Oracle::Varchar::view() const throw(Oracle::Error)
+{
+	if (ind == -1)
+		throw Value_Error("Varchar::view()", "Cannot view a NULL");
+	return Str_View(vc, length());
+}
+
+
+int
+Oracle::Varchar::length() const throw()
+{
+	// OCI may or may not count the terminator in a returned length
+	int n = len;
+	if (n > 0 && vc[n - 1] == '\0')
+		n--;
+	return n;
+}
+
+
 long
 Oracle::Varchar::lng() const throw(Oracle::Error)
 {
@@ -192,15 +222,18 @@ Oracle::Varchar::dbl(const double n) const throw(Oracle::Error)
 Oracle::Varchar&
 Oracle::Varchar::operator=(const char* s) throw()
 {
-	if (strlen(s) >= max_sz)
+	int n = std::strlen(s) + 1;
+	if (n > max_sz)
 	{
-		if (vc)
+		if (vc && !ext)
 			delete [] vc;
-		vc = new char[strlen(s) + 1];
-		max_sz = strlen(s) + 1;
+		vc = new char[n];
+		max_sz = n;
+		ext = false;
 	}
 
-	strcpy(vc, s);
+	std::memcpy(vc, s, n);
+	len = n;
 	ind = 0;
 	return *this;
 }
@@ -221,7 +254,20 @@ Oracle::Varchar::operator=(const Oracle::Varchar& rhs) throw()
 	{
 		ind = rhs.ind;
 		if (ind == 0)
-			this->operator=(rhs.vc);
+		{
+			int n = rhs.length();
+			if (n >= max_sz)
+			{
+				if (vc && !ext)
+					delete [] vc;
+				vc = new char[n + 1];
+				max_sz = n + 1;
+				ext = false;
+			}
+			std::memcpy(vc, rhs.vc, n);
+			vc[n] = 0;
+			len = n + 1;
+		}
 	}
 	return *this;
 }
@@ -254,7 +300,7 @@ Oracle::operator==(const Oracle::Varchar& v1, const Oracle::Varchar& v2)
 		return false;
 	else if (&v1 == &v2)
 		return true;
-	else if (v1.str() == v2.str())
+	else if (v1.view() == v2.view())
 		return true;
 	else
 		return false;
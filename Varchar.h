@@ -44,6 +44,8 @@ namespace Oracle
 				const std::string&,						
 				const std::string&) const		throw();
 			virtual std::string sql_str() const		throw();	// return a string
+			virtual Str_View view() const			throw(Error);	// return characters without copying
+			int length() const				throw();	// number of characters
 			virtual long lng() const			throw(Error);	// return a long
 			virtual long lng(const long) const		throw(Error);	// return a long or given long if null
 			virtual double dbl() const			throw(Error);	// return a double
@@ -60,13 +62,22 @@ namespace Oracle
 			Varchar& operator=(const double)		throw();
 
 		protected:
+			// constructor
+			Varchar(char*, const int)			throw();	// use given storage of n + 1 chars
+
 			// data members
 			char* vc;							// value
 			int max_sz;							// max size
+			ub2 len;							// length incl. terminator, or as returned by OCI
+			bool ext;							// vc is not owned
 
 			// implementors
 			virtual void* data() const 			throw()
 				{ return (void*)vc; };
+			virtual ub2* len_addr()				throw()
+				{ return &len; }
+
+		friend class Rowtype;
 	};
 
 	inline std::ostream& operator<<(std::ostream& o, const Varchar& v)
@@ -0,0 +1,95 @@
+//////////////////////////////////////////////////////////////////////////////
+//
+// Ora++ -- a C++ interface to Oracle based on the Oracle Call Interface
+// Copyright (C) 2000-1 James Edwin Cain <me@jimcain.net>
+// 
+// This library is free software; you can redistribute it and/or modify it
+// under the terms of the GNU Lesser General Public License as published by
+// the Free Software Foundation; either version 2.1 of the License, or any
+// later version.
+// 
+// This library is distributed in the hope that it will be useful, but
+// WITHOUT ANY WARRANTY; without even the implied warranty of
+// MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the GNU Lesser
+// General Public License for more details.
+// 
+// You should have received a copy of the GNU Lesser General Public License
+// along with this library; if not, write to the Free Software Foundation,
+// Inc., 59 Temple Place, Suite 330, Boston, MA 02111-1307 USA.
+//
+//////////////////////////////////////////////////////////////////////////////
+
+// Multi-threaded microbenchmark of Number and Date arithmetic.  No database
+// connection is needed.  Runs the same per-thread workload with 1, 2, 4, ...
+// threads and prints operations per second; with per-thread error handles
+// the rate should grow with the number of threads, up to the core count.
+//
+//	usage: bench_values [max_threads [ops_per_thread]]
+
+#include "Ora++.h"
+#include <iostream>
+#include <cstdlib>
+#include <pthread.h>
+
+using namespace std;
+using namespace Oracle;
+
+
+namespace
+{
+	int ops = 100000;
+
+	void*
+	work(void* arg)
+	{
+		long* sum = (long*) arg;
+		try
+		{
+			Number total(0);
+			Date d("2001/01/01 00:00:00", "YYYY/MM/DD HH24:MI:SS");
+			for (int i=0; i < ops; i++)
+			{
+				Number n(i);
+				n *= Number(1.5);
+				total += n.round();
+				d += Days(1);
+				*sum += n.lng() + total.str().length() + d.str().length();
+			}
+		}
+		catch (Error& e)
+		{
+			cerr << e.str() << endl;
+		}
+		return 0;
+	}
+}
+
+
+int
+main(int argc, char** argv)
+{
+	int max_thr = argc > 1 ? atoi(argv[1]) : 8;
+	if (argc > 2)
+		ops = atoi(argv[2]);
+
+	for (int n=1; n <= max_thr; n *= 2)
+	{
+		pthread_t* thr = new pthread_t[n];
+		long* sums = new long[n];
+		double t = Env::now();
+		for (int i=0; i < n; i++)
+		{
+			sums[i] = 0;
+			pthread_create(&thr[i], 0, work, &sums[i]);
+		}
+		for (int i=0; i < n; i++)
+			pthread_join(thr[i], 0);
+		t = Env::now() - t;
+
+		cout << n << " threads: " << (long) (n * ops / t) << " iterations/sec ("
+			<< t << " secs)" << endl;
+		delete [] thr;
+		delete [] sums;
+	}
+	return 0;
+}